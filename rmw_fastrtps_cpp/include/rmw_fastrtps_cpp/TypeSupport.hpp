@@ -43,6 +43,12 @@ public:
   bool deserializeROSmessage(
     eprosima::fastcdr::Cdr & deser, void * ros_message, const void * impl);
 
+  // Messages of a bounded, non empty type have a fixed maximum serialized size
+  bool is_bounded() const
+  {
+    return max_size_bound_ && has_data_;
+  }
+
 protected:
   TypeSupport();
 
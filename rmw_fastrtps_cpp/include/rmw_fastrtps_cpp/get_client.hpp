@@ -36,6 +36,9 @@ get_request_publisher(rmw_client_t * client);
 
 /// Return a native FastRTPS subscriber handle for the response.
 /**
+ * The subscriber is shared by the clients of the participant which use the same service and
+ * QoS, so it also receives the responses to their requests.
+ *
  * The function returns `NULL` when either the client handle is `NULL` or
  * when the client handle is from a different rmw implementation.
  *
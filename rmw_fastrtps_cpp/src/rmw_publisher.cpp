@@ -41,21 +41,21 @@ rmw_init_publisher_allocation(
   const rosidl_message_bounds_t * message_bounds,
   rmw_publisher_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) type_support;
-  (void) message_bounds;
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  size_t max_serialized_size = 0;
+  rmw_ret_t ret = rmw_get_serialized_message_size(
+    type_support, message_bounds, &max_serialized_size);
+  if (ret != RMW_RET_OK) {
+    return ret;  // Error message already set
+  }
+  return rmw_fastrtps_shared_cpp::__rmw_init_publisher_allocation(
+    eprosima_fastrtps_identifier, max_serialized_size, allocation);
 }
 
 rmw_ret_t
 rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  return rmw_fastrtps_shared_cpp::__rmw_fini_publisher_allocation(
+    eprosima_fastrtps_identifier, allocation);
 }
 
 rmw_publisher_t *
@@ -171,6 +171,7 @@ rmw_create_publisher(
     RMW_SET_ERROR_MSG("failed to get datawriter qos");
     goto fail;
   }
+  publisherParam.qos.m_userData.setDataVec(impl->node_user_data);
 
   info->listener_ = new (std::nothrow) PubListener(info);
   if (!info->listener_) {
@@ -198,12 +199,15 @@ rmw_create_publisher(
   }
   memcpy(info->publisher_gid.data, guid, sizeof(eprosima::fastrtps::rtps::GUID_t));
 
+  info->loan_pool_ = _create_loaned_message_pool(
+    type_supports, type_support, static_cast<TypeSupport_cpp *>(info->type_support_));
+
   rmw_publisher = rmw_publisher_allocate();
   if (!rmw_publisher) {
     RMW_SET_ERROR_MSG("failed to allocate publisher");
     goto fail;
   }
-  rmw_publisher->can_loan_messages = false;
+  rmw_publisher->can_loan_messages = info->loan_pool_ != nullptr;
   rmw_publisher->implementation_identifier = eprosima_fastrtps_identifier;
   rmw_publisher->data = info;
   rmw_publisher->topic_name = reinterpret_cast<char *>(rmw_allocate(strlen(topic_name) + 1));
@@ -268,12 +272,10 @@ rmw_borrow_loaned_message(
   const rosidl_message_type_support_t * type_support,
   void ** ros_message)
 {
-  (void) publisher;
   (void) type_support;
-  (void) ros_message;
 
-  RMW_SET_ERROR_MSG("rmw_borrow_loaned_message not implemented for rmw_fastrtps_cpp");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_fastrtps_shared_cpp::__rmw_borrow_loaned_message(
+    eprosima_fastrtps_identifier, publisher, ros_message);
 }
 
 rmw_ret_t
@@ -281,12 +283,8 @@ rmw_return_loaned_message_from_publisher(
   const rmw_publisher_t * publisher,
   void * loaned_message)
 {
-  (void) publisher;
-  (void) loaned_message;
-
-  RMW_SET_ERROR_MSG(
-    "rmw_return_loaned_message_from_publisher not implemented for rmw_fastrtps_cpp");
-  return RMW_RET_UNSUPPORTED;
+  return rmw_fastrtps_shared_cpp::__rmw_return_loaned_message_from_publisher(
+    eprosima_fastrtps_identifier, publisher, loaned_message);
 }
 
 rmw_ret_t
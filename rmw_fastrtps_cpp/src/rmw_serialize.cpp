@@ -12,14 +12,56 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "fastcdr/FastBuffer.h"
 
 #include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
 #include "rmw/serialized_message.h"
 #include "rmw/rmw.h"
 
 #include "./type_support_common.hpp"
 
+namespace
+{
+struct CachedTypeSupport
+{
+  std::string message_namespace;
+  std::string message_name;
+  std::shared_ptr<MessageTypeSupport_cpp> type_support;
+};
+
+// Building a type support computes the maximum serialized size of the type, so it is done
+// once per type. Type supports only read their members while (de)serializing, so they can
+// be shared by threads.
+// A type support library can be unloaded and another one loaded at the same address, so the
+// name of the type is checked along with the address of its callbacks. A type support being
+// replaced stays alive until the calls using it return.
+std::shared_ptr<MessageTypeSupport_cpp>
+_get_message_type_support(const message_type_support_callbacks_t * callbacks)
+{
+  static std::mutex mutex;
+  static std::map<const void *, CachedTypeSupport> cache;
+
+  std::lock_guard<std::mutex> guard(mutex);
+  CachedTypeSupport & cached = cache[callbacks];
+  if (
+    !cached.type_support ||
+    cached.message_namespace != callbacks->message_namespace_ ||
+    cached.message_name != callbacks->message_name_)
+  {
+    cached.message_namespace = callbacks->message_namespace_;
+    cached.message_name = callbacks->message_name_;
+    cached.type_support = std::make_shared<MessageTypeSupport_cpp>(callbacks);
+  }
+  return cached.type_support;
+}
+}  // namespace
+
 extern "C"
 {
 rmw_ret_t
@@ -40,7 +82,7 @@ rmw_serialize(
   }
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
+  auto tss = _get_message_type_support(callbacks);
   auto data_length = tss->getEstimatedSerializedSize(ros_message, callbacks);
   if (serialized_message->buffer_capacity < data_length) {
     if (rmw_serialized_message_resize(serialized_message, data_length) != RMW_RET_OK) {
@@ -57,7 +99,6 @@ rmw_serialize(
   auto ret = tss->serializeROSmessage(ros_message, ser, callbacks);
   serialized_message->buffer_length = data_length;
   serialized_message->buffer_capacity = data_length;
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -79,24 +120,45 @@ rmw_deserialize(
   }
 
   auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
-  auto tss = new MessageTypeSupport_cpp(callbacks);
+  auto tss = _get_message_type_support(callbacks);
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), serialized_message->buffer_length);
   eprosima::fastcdr::Cdr deser(buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
     eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->deserializeROSmessage(deser, ros_message, callbacks);
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
 rmw_ret_t
 rmw_get_serialized_message_size(
-  const rosidl_message_type_support_t * /*type_support*/,
+  const rosidl_message_type_support_t * type_support,
   const rosidl_message_bounds_t * /*message_bounds*/,
-  size_t * /*size*/)
+  size_t * size)
 {
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+
+  const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
+    type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_C);
+  if (!ts) {
+    ts = get_message_typesupport_handle(
+      type_support, RMW_FASTRTPS_CPP_TYPESUPPORT_CPP);
+    if (!ts) {
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  auto callbacks = static_cast<const message_type_support_callbacks_t *>(ts->data);
+  auto tss = _get_message_type_support(callbacks);
+  if (tss->getMaxSerializedSize() == 0) {
+    // The size of a message of an unbounded type depends on its content. Message bounds would
+    // tell the maximum one, but they carry no information the generators fill in yet.
+    RMW_SET_ERROR_MSG("serialized message size of unbounded types is not supported");
+    return RMW_RET_UNSUPPORTED;
+  }
+  *size = tss->getMaxSerializedSize();
+  return RMW_RET_OK;
 }
 }  // extern "C"
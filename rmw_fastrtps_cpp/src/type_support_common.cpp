@@ -12,12 +12,111 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <new>
 #include <string>
 
 #include "rmw/error_handling.h"
 
+#include "rosidl_typesupport_introspection_c/field_types.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
 #include "type_support_common.hpp"
 
+namespace
+{
+// Number of messages allocated up front for each publisher or subscription which can loan them
+const size_t loaned_message_pool_size = 4;
+
+// A plain message has no string nor sequence, and neither have its nested messages
+template<typename MembersType>
+bool
+_is_plain(const MembersType * members)
+{
+  for (uint32_t i = 0; i < members->member_count_; ++i) {
+    const auto & member = members->members_[i];
+    if (member.is_array_ && (member.array_size_ == 0 || member.is_upper_bound_)) {
+      return false;
+    }
+    switch (member.type_id_) {
+      case ::rosidl_typesupport_introspection_c__ROS_TYPE_STRING:
+      case ::rosidl_typesupport_introspection_c__ROS_TYPE_WSTRING:
+        return false;
+      case ::rosidl_typesupport_introspection_c__ROS_TYPE_MESSAGE:
+        if (!_is_plain(static_cast<const MembersType *>(member.members_->data))) {
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+std::unique_ptr<rmw_fastrtps_shared_cpp::LoanedMessagePool>
+_create_loaned_message_pool(
+  const rosidl_message_type_support_t * type_supports,
+  const rosidl_message_type_support_t * type_support,
+  const TypeSupport_cpp * typed_typesupport)
+{
+  using rmw_fastrtps_shared_cpp::LoanedMessagePool;
+
+  if (!typed_typesupport->is_bounded()) {
+    return nullptr;
+  }
+
+  // The generated Fast CDR code knows nothing about the memory layout of messages, look at the
+  // introspection type support of the same language
+  if (type_support->typesupport_identifier == RMW_FASTRTPS_CPP_TYPESUPPORT_C) {
+    const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+      type_supports, rosidl_typesupport_introspection_c__identifier);
+    if (!introspection) {
+      rmw_reset_error();
+      return nullptr;
+    }
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(introspection->data);
+    if (!_is_plain(members) || !members->init_function || !members->fini_function) {
+      return nullptr;
+    }
+    return std::unique_ptr<LoanedMessagePool>(
+      new (std::nothrow) LoanedMessagePool(
+        members->size_of_, loaned_message_pool_size,
+        [members](void * message) {
+          members->init_function(message, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+        },
+        [members](void * message) {
+          members->fini_function(message);
+        }));
+  }
+
+  const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+    type_supports, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (!introspection) {
+    rmw_reset_error();
+    return nullptr;
+  }
+  auto members =
+    static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(introspection->data);
+  if (!_is_plain(members) || !members->init_function || !members->fini_function) {
+    return nullptr;
+  }
+  return std::unique_ptr<LoanedMessagePool>(
+    new (std::nothrow) LoanedMessagePool(
+      members->size_of_, loaned_message_pool_size,
+      [members](void * message) {
+        members->init_function(message, rosidl_generator_cpp::MessageInitialization::ALL);
+      },
+      [members](void * message) {
+        members->fini_function(message);
+      }));
+}
+
 namespace rmw_fastrtps_cpp
 {
 
@@ -15,6 +15,7 @@
 #ifndef TYPE_SUPPORT_COMMON_HPP_
 #define TYPE_SUPPORT_COMMON_HPP_
 
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -23,6 +24,7 @@
 
 #include "rmw/error_handling.h"
 
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 #include "rmw_fastrtps_cpp/MessageTypeSupport.hpp"
@@ -69,4 +71,12 @@ _register_type(
   eprosima::fastrtps::Domain::registerType(participant, typed_typesupport);
 }
 
+// Create the pool of messages to loan for a type, if messages of this type are bounded and
+// plain, so they can be reused without being initialized again. Return nullptr otherwise.
+std::unique_ptr<rmw_fastrtps_shared_cpp::LoanedMessagePool>
+_create_loaned_message_pool(
+  const rosidl_message_type_support_t * type_supports,
+  const rosidl_message_type_support_t * type_support,
+  const TypeSupport_cpp * typed_typesupport);
+
 #endif  // TYPE_SUPPORT_COMMON_HPP_
@@ -0,0 +1,67 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_DYNAMIC_CPP__CLIENT_REQUESTS_HPP_
+#define RMW_FASTRTPS_DYNAMIC_CPP__CLIENT_REQUESTS_HPP_
+
+#include "rmw/rmw.h"
+#include "rmw/types.h"
+#include "rmw_fastrtps_dynamic_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_dynamic_cpp
+{
+
+/// Send a request which times out if its response does not arrive in time.
+/**
+ * Several requests of a client may be in flight at once, their responses are taken with
+ * take_response_for_request() in any order, or with rmw_take_response() in order of arrival.
+ * Responses arriving after the request timed out are dropped.
+ *
+ * \param client to send the request with
+ * \param ros_request to send
+ * \param timeout after which the request times out, a zero timeout never expires
+ * \param sequence_id set to the sequence number of the request
+ * \return RMW_RET_OK if successful, otherwise an error code
+ */
+RMW_FASTRTPS_DYNAMIC_CPP_PUBLIC
+rmw_ret_t
+send_request_with_timeout(
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_time_t timeout,
+  int64_t * sequence_id);
+
+/// Take the response to a request of a client, if it arrived.
+/**
+ * \param client which sent the request
+ * \param sequence_id of the request
+ * \param request_header set with the sequence number of the request, if taken
+ * \param ros_response set with the response, if taken
+ * \param taken set to whether the response was taken
+ * \return RMW_RET_OK if the response was taken or has not arrived yet, see taken
+ * \return RMW_RET_TIMEOUT if the request timed out, it is not in flight anymore after that
+ * \return RMW_RET_INVALID_ARGUMENT if the request is not in flight, or an argument is invalid
+ */
+RMW_FASTRTPS_DYNAMIC_CPP_PUBLIC
+rmw_ret_t
+take_response_for_request(
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken);
+
+}  // namespace rmw_fastrtps_dynamic_cpp
+
+#endif  // RMW_FASTRTPS_DYNAMIC_CPP__CLIENT_REQUESTS_HPP_
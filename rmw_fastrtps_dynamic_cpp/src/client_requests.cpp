@@ -0,0 +1,56 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rmw_fastrtps_dynamic_cpp/client_requests.hpp"
+
+#include "rmw/error_handling.h"
+
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
+#include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
+
+namespace rmw_fastrtps_dynamic_cpp
+{
+
+rmw_ret_t
+send_request_with_timeout(
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_time_t timeout,
+  int64_t * sequence_id)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_request, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(sequence_id, RMW_RET_INVALID_ARGUMENT);
+  return rmw_fastrtps_shared_cpp::__rmw_send_request_with_timeout(
+    eprosima_fastrtps_identifier, client, ros_request, timeout, sequence_id);
+}
+
+rmw_ret_t
+take_response_for_request(
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(client, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(request_header, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_response, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  return rmw_fastrtps_shared_cpp::__rmw_take_response_for_request(
+    eprosima_fastrtps_identifier, client, sequence_id, request_header, ros_response, taken);
+}
+
+}  // namespace rmw_fastrtps_dynamic_cpp
@@ -28,6 +28,7 @@
 #include "rmw_fastrtps_shared_cpp/names.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
+#include "rmw_fastrtps_shared_cpp/response_reader.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
@@ -98,8 +99,7 @@ rmw_create_client(
   info = new CustomClientInfo();
   info->participant_ = participant;
   info->typesupport_identifier_ = type_support->typesupport_identifier;
-  info->request_publisher_matched_count_ = 0;
-  info->response_subscriber_matched_count_ = 0;
+  info->server_available_ = false;
 
   const void * untyped_request_members;
   const void * untyped_response_members;
@@ -170,19 +170,24 @@ rmw_create_client(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
+  subscriberParam.qos.m_userData.setDataVec(impl->node_user_data);
+  info->graph_cache_ = impl->graph_cache;
   info->listener_ = new ClientListener(info);
-  info->response_subscriber_ =
-    Domain::createSubscriber(participant, subscriberParam, info->listener_);
-  if (!info->response_subscriber_) {
+  info->response_readers_ = impl->response_readers;
+  info->response_reader_ =
+    info->response_readers_->acquire(participant, subscriberParam, *qos_policies);
+  if (!info->response_reader_) {
     RMW_SET_ERROR_MSG("create_client() could not create subscriber");
     goto fail;
   }
+  info->response_subscriber_ = info->response_reader_->subscriber();
 
   // Create Client Subscriber and set QoS
   if (!get_datawriter_qos(*qos_policies, publisherParam)) {
     RMW_SET_ERROR_MSG("failed to get datawriter qos");
     goto fail;
   }
+  publisherParam.qos.m_userData.setDataVec(impl->node_user_data);
   info->pub_listener_ = new ClientPubListener(info);
   info->request_publisher_ =
     Domain::createPublisher(participant, publisherParam, info->pub_listener_);
@@ -192,6 +197,7 @@ rmw_create_client(
   }
 
   info->writer_guid_ = info->request_publisher_->getGuid();
+  info->response_reader_->addClient(info->writer_guid_, info->listener_);
 
   rmw_client = rmw_client_allocate();
   if (!rmw_client) {
@@ -217,8 +223,9 @@ fail:
       Domain::removePublisher(info->request_publisher_);
     }
 
-    if (info->response_subscriber_ != nullptr) {
-      Domain::removeSubscriber(info->response_subscriber_);
+    if (info->response_reader_) {
+      info->response_reader_->removeClient(info->writer_guid_);
+      info->response_readers_->release(info->response_reader_);
     }
 
     if (info->pub_listener_ != nullptr) {
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <mutex>
+#include <new>
+
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/rmw.h"
 
+#include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
+
 #include "rmw_fastrtps_dynamic_cpp/identifier.hpp"
 
 extern "C"
@@ -79,7 +84,13 @@ rmw_init(const rmw_init_options_t * options, rmw_context_t * context)
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
   context->instance_id = options->instance_id;
   context->implementation_identifier = eprosima_fastrtps_identifier;
-  context->impl = nullptr;
+  // Participants are created along with the first node which needs them, as the domain id and
+  // the security options are only known then.
+  context->impl = new (std::nothrow) rmw_context_impl_t();
+  if (nullptr == context->impl) {
+    RMW_SET_ERROR_MSG("failed to allocate context impl");
+    return RMW_RET_BAD_ALLOC;
+  }
   return RMW_RET_OK;
 }
 
@@ -106,8 +117,15 @@ rmw_context_fini(rmw_context_t * context)
     context->implementation_identifier,
     eprosima_fastrtps_identifier,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-  // context impl is explicitly supposed to be nullptr for now, see rmw_init's code
-  // RCUTILS_CHECK_ARGUMENT_FOR_NULL(context->impl, RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ARGUMENT_FOR_NULL(context->impl, RMW_RET_INVALID_ARGUMENT);
+  {
+    std::lock_guard<std::mutex> guard(context->impl->mutex);
+    if (!context->impl->participants.empty()) {
+      RMW_SET_ERROR_MSG("context still has nodes");
+      return RMW_RET_ERROR;
+    }
+  }
+  delete context->impl;
   *context = rmw_get_zero_initialized_context();
   return RMW_RET_OK;
 }
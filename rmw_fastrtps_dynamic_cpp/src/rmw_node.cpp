@@ -48,7 +48,8 @@ rmw_create_node(
     // TODO(wjwwood): replace this with RMW_RET_INCORRECT_RMW_IMPLEMENTATION when refactored
     return NULL);
   return rmw_fastrtps_shared_cpp::__rmw_create_node(
-    eprosima_fastrtps_identifier, name, namespace_, domain_id, security_options, localhost_only);
+    eprosima_fastrtps_identifier, context, name, namespace_, domain_id, security_options,
+    localhost_only);
 }
 
 rmw_ret_t
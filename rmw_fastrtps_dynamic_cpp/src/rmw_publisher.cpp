@@ -41,21 +41,21 @@ rmw_init_publisher_allocation(
   const rosidl_message_bounds_t * message_bounds,
   rmw_publisher_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) type_support;
-  (void) message_bounds;
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  size_t max_serialized_size = 0;
+  rmw_ret_t ret = rmw_get_serialized_message_size(
+    type_support, message_bounds, &max_serialized_size);
+  if (ret != RMW_RET_OK) {
+    return ret;  // Error message already set
+  }
+  return rmw_fastrtps_shared_cpp::__rmw_init_publisher_allocation(
+    eprosima_fastrtps_identifier, max_serialized_size, allocation);
 }
 
 rmw_ret_t
 rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  return rmw_fastrtps_shared_cpp::__rmw_fini_publisher_allocation(
+    eprosima_fastrtps_identifier, allocation);
 }
 
 rmw_publisher_t *
@@ -167,6 +167,7 @@ rmw_create_publisher(
     RMW_SET_ERROR_MSG("failed to get datawriter qos");
     goto fail;
   }
+  publisherParam.qos.m_userData.setDataVec(impl->node_user_data);
 
   info->listener_ = new (std::nothrow) PubListener(info);
   if (!info->listener_) {
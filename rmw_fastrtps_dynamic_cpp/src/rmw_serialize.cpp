@@ -12,14 +12,82 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "fastcdr/FastBuffer.h"
 
 #include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
 #include "rmw/serialized_message.h"
 #include "rmw/rmw.h"
 
 #include "./type_support_common.hpp"
 
+namespace
+{
+struct CachedTypeSupport
+{
+  std::string message_namespace;
+  std::string message_name;
+  std::shared_ptr<rmw_fastrtps_shared_cpp::TypeSupport> type_support;
+};
+
+template<typename MembersType>
+bool
+_is_cached_type(const CachedTypeSupport & cached, const void * untyped_members)
+{
+  auto members = static_cast<const MembersType *>(untyped_members);
+  return cached.message_namespace == members->message_namespace_ &&
+         cached.message_name == members->message_name_;
+}
+
+template<typename MembersType>
+void
+_set_cached_type(CachedTypeSupport & cached, const void * untyped_members)
+{
+  auto members = static_cast<const MembersType *>(untyped_members);
+  cached.message_namespace = members->message_namespace_;
+  cached.message_name = members->message_name_;
+}
+
+// Building a type support walks the whole introspection tree, so it is done once per type.
+// Type supports only read their members while (de)serializing, so they can be shared by threads.
+// A type support library can be unloaded and another one loaded at the same address, so the
+// name of the type is checked along with the address of its members. A type support being
+// replaced stays alive until the calls using it return.
+std::shared_ptr<rmw_fastrtps_shared_cpp::TypeSupport>
+_get_message_type_support(const rosidl_message_type_support_t * ts)
+{
+  static std::mutex mutex;
+  static std::map<const void *, CachedTypeSupport> cache;
+
+  bool is_c = using_introspection_c_typesupport(ts->typesupport_identifier);
+  if (!is_c && !using_introspection_cpp_typesupport(ts->typesupport_identifier)) {
+    RMW_SET_ERROR_MSG("Unknown typesupport identifier");
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex);
+  CachedTypeSupport & cached = cache[ts->data];
+  bool is_cached_type = is_c ?
+    _is_cached_type<rosidl_typesupport_introspection_c__MessageMembers>(cached, ts->data) :
+    _is_cached_type<rosidl_typesupport_introspection_cpp::MessageMembers>(cached, ts->data);
+  if (!cached.type_support || !is_cached_type) {
+    cached.type_support.reset(
+      _create_message_type_support(ts->data, ts->typesupport_identifier));
+    if (is_c) {
+      _set_cached_type<rosidl_typesupport_introspection_c__MessageMembers>(cached, ts->data);
+    } else {
+      _set_cached_type<rosidl_typesupport_introspection_cpp::MessageMembers>(cached, ts->data);
+    }
+  }
+  return cached.type_support;
+}
+}  // namespace
+
 extern "C"
 {
 rmw_ret_t
@@ -39,7 +107,10 @@ rmw_serialize(
     }
   }
 
-  auto tss = _create_message_type_support(ts->data, ts->typesupport_identifier);
+  auto tss = _get_message_type_support(ts);
+  if (!tss) {
+    return RMW_RET_ERROR;
+  }
   auto data_length = tss->getEstimatedSerializedSize(ros_message, ts->data);
   if (serialized_message->buffer_capacity < data_length) {
     if (rmw_serialized_message_resize(serialized_message, data_length) != RMW_RET_OK) {
@@ -57,7 +128,6 @@ rmw_serialize(
   auto ret = tss->serializeROSmessage(ros_message, ser, ts->data);
   serialized_message->buffer_length = data_length;
   serialized_message->buffer_capacity = data_length;
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
@@ -78,24 +148,50 @@ rmw_deserialize(
     }
   }
 
-  auto tss = _create_message_type_support(ts->data, ts->typesupport_identifier);
+  auto tss = _get_message_type_support(ts);
+  if (!tss) {
+    return RMW_RET_ERROR;
+  }
   eprosima::fastcdr::FastBuffer buffer(
     reinterpret_cast<char *>(serialized_message->buffer), serialized_message->buffer_length);
   eprosima::fastcdr::Cdr deser(buffer, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
     eprosima::fastcdr::Cdr::DDS_CDR);
 
   auto ret = tss->deserializeROSmessage(deser, ros_message, ts->data);
-  delete tss;
   return ret == true ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
 rmw_ret_t
 rmw_get_serialized_message_size(
-  const rosidl_message_type_support_t * /*type_support*/,
+  const rosidl_message_type_support_t * type_support,
   const rosidl_message_bounds_t * /*message_bounds*/,
-  size_t * /*size*/)
+  size_t * size)
 {
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+
+  const rosidl_message_type_support_t * ts = get_message_typesupport_handle(
+    type_support, rosidl_typesupport_introspection_c__identifier);
+  if (!ts) {
+    ts = get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+    if (!ts) {
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  auto tss = _get_message_type_support(ts);
+  if (!tss) {
+    return RMW_RET_ERROR;
+  }
+  if (tss->getMaxSerializedSize() == 0) {
+    // The size of a message of an unbounded type depends on its content. Message bounds would
+    // tell the maximum one, but they carry no information the generators fill in yet.
+    RMW_SET_ERROR_MSG("serialized message size of unbounded types is not supported");
+    return RMW_RET_UNSUPPORTED;
+  }
+  *size = tss->getMaxSerializedSize();
+  return RMW_RET_OK;
 }
 }  // extern "C"
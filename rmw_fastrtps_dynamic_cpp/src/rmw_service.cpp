@@ -180,6 +180,7 @@ rmw_create_service(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
+  subscriberParam.qos.m_userData.setDataVec(impl->node_user_data);
   info->listener_ = new ServiceListener(info);
   info->request_subscriber_ =
     Domain::createSubscriber(participant, subscriberParam, info->listener_);
@@ -193,6 +194,7 @@ rmw_create_service(
     RMW_SET_ERROR_MSG("failed to get datawriter qos");
     goto fail;
   }
+  publisherParam.qos.m_userData.setDataVec(impl->node_user_data);
   info->response_publisher_ =
     Domain::createPublisher(participant, publisherParam, nullptr);
   if (!info->response_publisher_) {
@@ -45,21 +45,21 @@ rmw_init_subscription_allocation(
   const rosidl_message_bounds_t * message_bounds,
   rmw_subscription_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) type_support;
-  (void) message_bounds;
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  size_t max_serialized_size = 0;
+  rmw_ret_t ret = rmw_get_serialized_message_size(
+    type_support, message_bounds, &max_serialized_size);
+  if (ret != RMW_RET_OK) {
+    return ret;  // Error message already set
+  }
+  return rmw_fastrtps_shared_cpp::__rmw_init_subscription_allocation(
+    eprosima_fastrtps_identifier, max_serialized_size, allocation);
 }
 
 rmw_ret_t
 rmw_fini_subscription_allocation(rmw_subscription_allocation_t * allocation)
 {
-  // Unused in current implementation.
-  (void) allocation;
-  RMW_SET_ERROR_MSG("unimplemented");
-  return RMW_RET_ERROR;
+  return rmw_fastrtps_shared_cpp::__rmw_fini_subscription_allocation(
+    eprosima_fastrtps_identifier, allocation);
 }
 
 rmw_subscription_t *
@@ -160,6 +160,7 @@ rmw_create_subscription(
     RMW_SET_ERROR_MSG("failed to get datareader qos");
     goto fail;
   }
+  subscriberParam.qos.m_userData.setDataVec(impl->node_user_data);
 
   info->listener_ = new (std::nothrow) SubListener(info);
   if (!info->listener_) {
@@ -31,11 +31,16 @@ namespace rmw_fastrtps_shared_cpp
 {
 
 // Publishers write method will receive a pointer to this struct
+// Subscribers takeNextData method too, with a pointer to a FastBuffer instead of a Cdr. A buffer
+// which already has storage is reused: the payload is copied at its start, after growing the
+// storage if the buffer owns it. Otherwise the buffer allocates storage for the payload.
+// A null FastBuffer pointer takes the sample without copying its payload, to discard it.
 struct SerializedData
 {
   bool is_cdr_buffer;  // Whether next field is a pointer to a Cdr or to a plain ros message
   void * data;
   const void * impl;   // RMW implementation specific data
+  size_t length;       // Length of the payload taken into a FastBuffer
 };
 
 class TypeSupport : public eprosima::fastrtps::TopicDataType
@@ -74,6 +79,12 @@ public:
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   void deleteData(void * data) override;
 
+  // Serialized messages of a bounded type, encapsulation included, are never bigger than this
+  size_t getMaxSerializedSize() const
+  {
+    return max_size_bound_ ? m_typeSize : 0u;
+  }
+
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   virtual ~TypeSupport() {}
 
@@ -0,0 +1,50 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_ALLOCATION_INFO_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__CUSTOM_ALLOCATION_INFO_HPP_
+
+#include <cstddef>
+
+#include "fastcdr/FastBuffer.h"
+
+#include "fastrtps/subscriber/SampleInfo.h"
+
+#include "rmw/types.h"
+
+// Data of the publisher and subscription allocations, created along with them before the
+// message type is used, so that publishing and taking do not need to allocate.
+typedef struct CustomAllocationInfo
+{
+  // Maximum serialized size of the messages of the type, encapsulation included
+  size_t max_serialized_size_;
+  // Serialized messages are taken into it, owns max_serialized_size_ bytes for subscriptions and
+  // is empty for publishers, which serialize straight into the change payload
+  eprosima::fastcdr::FastBuffer buffer_;
+  // Info of the samples taken
+  eprosima::fastrtps::SampleInfo_t sample_info_;
+} CustomAllocationInfo;
+
+namespace rmw_fastrtps_shared_cpp
+{
+/// Return the data of an allocation, or nullptr with the error message set if it is invalid.
+CustomAllocationInfo *
+get_allocation_info(const char * identifier, rmw_publisher_allocation_t * allocation);
+
+/// Return the data of an allocation, or nullptr with the error message set if it is invalid.
+CustomAllocationInfo *
+get_allocation_info(const char * identifier, rmw_subscription_allocation_t * allocation);
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_ALLOCATION_INFO_HPP_
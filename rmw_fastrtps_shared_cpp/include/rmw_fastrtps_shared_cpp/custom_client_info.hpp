@@ -16,44 +16,61 @@
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_CLIENT_INFO_HPP_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <list>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "fastcdr/FastBuffer.h"
 
 #include "fastrtps/subscriber/SampleInfo.h"
 #include "fastrtps/subscriber/Subscriber.h"
-#include "fastrtps/subscriber/SubscriberListener.h"
 #include "fastrtps/participant/Participant.h"
 #include "fastrtps/publisher/Publisher.h"
 #include "fastrtps/publisher/PublisherListener.h"
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw_fastrtps_shared_cpp/graph_cache.hpp"
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
+#include "rmw_fastrtps_shared_cpp/ring_buffer.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 class ClientListener;
 class ClientPubListener;
 
+namespace rmw_fastrtps_shared_cpp
+{
+class ResponseReader;
+class ResponseReaders;
+}  // namespace rmw_fastrtps_shared_cpp
+
 typedef struct CustomClientInfo
 {
   rmw_fastrtps_shared_cpp::TypeSupport * request_type_support_;
   const void * request_type_support_impl_;
   rmw_fastrtps_shared_cpp::TypeSupport * response_type_support_;
   const void * response_type_support_impl_;
+  // Subscriber of response_reader_, shared with the other clients of the participant which
+  // use the same response topic and QoS
   eprosima::fastrtps::Subscriber * response_subscriber_;
+  std::shared_ptr<rmw_fastrtps_shared_cpp::ResponseReader> response_reader_;
+  // Response readers of the participant, response_reader_ is released to them
+  std::shared_ptr<rmw_fastrtps_shared_cpp::ResponseReaders> response_readers_;
   eprosima::fastrtps::Publisher * request_publisher_;
   ClientListener * listener_;
   eprosima::fastrtps::rtps::GUID_t writer_guid_;
   eprosima::fastrtps::Participant * participant_;
   const char * typesupport_identifier_;
   ClientPubListener * pub_listener_;
-  std::atomic_size_t response_subscriber_matched_count_;
-  std::atomic_size_t request_publisher_matched_count_;
+  // Graph of the participant, its guard conditions are triggered once a server is available
+  std::shared_ptr<GraphCache> graph_cache_;
+  // Whether both the request and the response endpoints of a service server are matched
+  std::atomic_bool server_available_;
 } CustomClientInfo;
 
 typedef struct CustomClientResponse
@@ -62,53 +79,147 @@ typedef struct CustomClientResponse
   std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer_;
 } CustomClientResponse;
 
-class ClientListener : public eprosima::fastrtps::SubscriberListener
+/// Requests of a client in flight, and their responses waiting to be taken.
+/**
+ * Requests are tracked by sequence number from the time they are sent until their response is
+ * taken, either in order of arrival or by sequence number. Responses are handed over by the
+ * ResponseReader of the client. Those to requests which are not in flight anymore, because they
+ * timed out or were answered already, are dropped before they are deserialized.
+ *
+ * Requests are kept in an open addressed table allocated at creation, so that tracking a request
+ * does not allocate. The table only grows, doubling, once it is three quarters full of requests
+ * in flight: requests waiting for their response, or whose response was not taken, are never
+ * dropped. Requests which timed out are reported as such until the table needs their slot.
+ *
+ * A response may arrive before the call sending its request returns, so responses to sequence
+ * numbers after the last request sent are kept for it, for a while. This relies on the requests
+ * of a client not being sent from several threads at once.
+ */
+class ClientListener
 {
 public:
-  explicit ClientListener(CustomClientInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+  /// State of a request in flight.
+  enum class RequestState
+  {
+    // Waiting for a response
+    pending,
+    // Response arrived
+    completed,
+    // Deadline passed before a response arrived
+    timed_out,
+    // Not in flight
+    unknown
+  };
 
+  /**
+   * \param info of the client
+   * \param capacity number of slots of the table of requests allocated at creation
+   */
+  explicit ClientListener(CustomClientInfo * info, size_t capacity = 256)
+  : info_(info), request_subscribers_(0), response_publishers_(0),
+    in_flight_(capacity > 4 ? capacity : 4), in_flight_count_(0),
+    last_sequence_number_(0), next_expiry_(std::chrono::steady_clock::time_point::max()),
+    completed_count_(0), list_has_data_(false),
+    conditionMutex_(nullptr), conditionVariable_(nullptr), readyList_(nullptr)
+  {}
 
+  /// Update the number of subscribers matched with the request publisher of the client.
   void
-  onNewDataMessage(eprosima::fastrtps::Subscriber * sub)
+  requestSubscribersMatched(size_t count)
   {
-    assert(sub);
+    updateServerAvailable(request_subscribers_, count);
+  }
 
-    CustomClientResponse response;
-    // Todo(sloretz) eliminate heap allocation pending eprosima/Fast-CDR#19
-    response.buffer_.reset(new eprosima::fastcdr::FastBuffer());
-    eprosima::fastrtps::SampleInfo_t sinfo;
-
-    rmw_fastrtps_shared_cpp::SerializedData data;
-    data.is_cdr_buffer = true;
-    data.data = response.buffer_.get();
-    data.impl = nullptr;    // not used when is_cdr_buffer is true
-    if (sub->takeNextData(&data, &sinfo)) {
-      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-        response.sample_identity_ = sinfo.related_sample_identity;
-
-        if (response.sample_identity_.writer_guid() == info_->writer_guid_) {
-          std::lock_guard<std::mutex> lock(internalMutex_);
-
-          if (conditionMutex_ != nullptr) {
-            std::unique_lock<std::mutex> clock(*conditionMutex_);
-            list.emplace_back(std::move(response));
-            // the change to list_has_data_ needs to be mutually exclusive with
-            // rmw_wait() which checks hasData() and decides if wait() needs to
-            // be called
-            list_has_data_.store(true);
-            clock.unlock();
-            conditionVariable_->notify_one();
-          } else {
-            list.emplace_back(std::move(response));
-            list_has_data_.store(true);
-          }
-        }
+  /// Update the number of publishers matched with the response reader of the client.
+  void
+  responsePublishersMatched(size_t count)
+  {
+    updateServerAvailable(response_publishers_, count);
+  }
+
+  /// Track a request which was just sent.
+  /**
+   * \param sequence_number of the request
+   * \param deadline after which the request times out, if it has no response yet
+   */
+  void
+  addRequest(int64_t sequence_number, std::chrono::steady_clock::time_point deadline)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    if (conditionMutex_ != nullptr) {
+      std::unique_lock<std::mutex> clock(*conditionMutex_);
+      trackRequest(sequence_number, deadline);
+      return;
+    }
+    trackRequest(sequence_number, deadline);
+  }
+
+  /// Return whether the response to a request would be queued.
+  bool
+  expectsResponse(const eprosima::fastrtps::rtps::SampleIdentity & related_sample_identity)
+  {
+    int64_t sequence_number = getSequenceNumber(related_sample_identity);
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    InFlightRequest * request = findRequest(sequence_number);
+    if (request == nullptr) {
+      return sequence_number > last_sequence_number_;
+    }
+    return isPending(*request, std::chrono::steady_clock::now());
+  }
+
+  /// Queue the response to a request in flight.
+  /**
+   * \return true if the response was queued and moved from, false if it was dropped
+   */
+  bool
+  pushResponse(CustomClientResponse & response)
+  {
+    int64_t sequence_number = getSequenceNumber(response.sample_identity_);
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    InFlightRequest * request = findRequest(sequence_number);
+    if (request == nullptr) {
+      if (sequence_number <= last_sequence_number_) {
+        // The request timed out, or it was answered already
+        return false;
+      }
+      // The request is still being sent, the response is dropped if it never is
+      request = &insertRequest(sequence_number, now + earlyResponseLifetime());
+      request->sent = false;
+    } else if (!isPending(*request, now)) {
+      return false;
+    }
+    request->state = RequestState::completed;
+    request->response = std::move(response);
+    ++completed_count_;
+
+    if (conditionMutex_ != nullptr) {
+      std::unique_lock<std::mutex> clock(*conditionMutex_);
+      completed_.push_back(std::move(sequence_number));
+      // the change to list_has_data_ needs to be mutually exclusive with
+      // rmw_wait() which checks hasData() and decides if wait() needs to
+      // be called
+      list_has_data_.store(true);
+      readyList_->push(&readyListEntry_);
+      clock.unlock();
+      conditionVariable_->notify_one();
+    } else {
+      completed_.push_back(std::move(sequence_number));
+      list_has_data_.store(true);
+      if (readyList_ != nullptr) {
+        // Attached to a wait set which parks on its ready list
+        readyList_->push(&readyListEntry_);
       }
     }
+    return true;
   }
 
+  /// Take the response which arrived first.
+  /**
+   * Requests which expired are purged first, see getResponse(int64_t, CustomClientResponse &).
+   */
   bool
   getResponse(CustomClientResponse & response)
   {
@@ -121,12 +232,36 @@ public:
     return popResponse(response);
   }
 
+  /// Take the response to a request, if it arrived.
+  /**
+   * A request is forgotten once its response is taken, or once it is reported as timed out.
+   * Requests which expired are purged first: those which timed out are marked as such, and
+   * responses kept for requests which were never sent are dropped.
+   *
+   * \return the state of the request, response is only set if it is completed
+   */
+  RequestState
+  getResponse(int64_t sequence_number, CustomClientResponse & response)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    if (conditionMutex_ != nullptr) {
+      std::unique_lock<std::mutex> clock(*conditionMutex_);
+      return popResponse(sequence_number, response);
+    }
+    return popResponse(sequence_number, response);
+  }
+
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyList_ = readyList;
   }
 
   void
@@ -135,6 +270,13 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyList_ = nullptr;
+  }
+
+  rmw_fastrtps_shared_cpp::ReadyListEntry *
+  getReadyListEntry()
+  {
+    return &readyListEntry_;
   }
 
   bool
@@ -143,43 +285,285 @@ public:
     return list_has_data_.load();
   }
 
-  void onSubscriptionMatched(
-    eprosima::fastrtps::Subscriber * sub,
-    eprosima::fastrtps::rtps::MatchingInfo & matchingInfo)
+  static int64_t
+  getSequenceNumber(const eprosima::fastrtps::rtps::SampleIdentity & sample_identity)
   {
-    (void)sub;
-    if (info_ == nullptr) {
+    return ((int64_t)sample_identity.sequence_number().high) << 32 |
+           sample_identity.sequence_number().low;
+  }
+
+private:
+  void
+  updateServerAvailable(size_t & matched, size_t count)
+  {
+    bool became_available = false;
+    {
+      std::lock_guard<std::mutex> lock(availabilityMutex_);
+      matched = count;
+      bool available = request_subscribers_ > 0 && response_publishers_ > 0;
+      became_available = info_->server_available_.exchange(available) != available && available;
+    }
+    if (became_available && info_->graph_cache_) {
+      // Endpoints are matched after they are discovered, so waiting for the graph to change
+      // may not be enough to see the server available
+      info_->graph_cache_->trigger_graph_guard_conditions();
+    }
+  }
+
+  static std::chrono::steady_clock::duration
+  earlyResponseLifetime()
+  {
+    return std::chrono::seconds(5);
+  }
+
+  struct InFlightRequest
+  {
+    InFlightRequest()
+    : sequence_number(0), state(RequestState::unknown), sent(false) {}
+
+    // Sequence numbers start at 1, 0 marks a free slot
+    int64_t sequence_number;
+    RequestState state;
+    // Whether the call sending the request returned
+    bool sent;
+    // Timeout of a pending request, or lifetime of a response to a request never sent
+    std::chrono::steady_clock::time_point deadline;
+    // Only set once the response arrived
+    CustomClientResponse response;
+  };
+
+  static bool
+  isPending(const InFlightRequest & request, std::chrono::steady_clock::time_point now)
+  {
+    return RequestState::pending == request.state && now < request.deadline;
+  }
+
+  static bool
+  canExpire(const InFlightRequest & request)
+  {
+    return RequestState::pending == request.state ||
+           (RequestState::completed == request.state && !request.sent);
+  }
+
+  static size_t
+  homeSlot(int64_t sequence_number, size_t capacity)
+  {
+    return static_cast<size_t>(static_cast<uint64_t>(sequence_number) % capacity);
+  }
+
+  // The table always has a free slot, which ends the probing
+  InFlightRequest *
+  findRequest(int64_t sequence_number) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    size_t index = homeSlot(sequence_number, in_flight_.size());
+    while (in_flight_[index].sequence_number != 0) {
+      if (in_flight_[index].sequence_number == sequence_number) {
+        return &in_flight_[index];
+      }
+      index = (index + 1) % in_flight_.size();
+    }
+    return nullptr;
+  }
+
+  void
+  trackRequest(int64_t sequence_number, std::chrono::steady_clock::time_point deadline)
+  RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    if (sequence_number > last_sequence_number_) {
+      last_sequence_number_ = sequence_number;
+    }
+    purgeExpired(std::chrono::steady_clock::now());
+    InFlightRequest * request = findRequest(sequence_number);
+    if (request != nullptr) {
+      // The response arrived already
+      request->sent = true;
       return;
     }
-    if (eprosima::fastrtps::rtps::MATCHED_MATCHING == matchingInfo.status) {
-      publishers_.insert(matchingInfo.remoteEndpointGuid);
-    } else if (eprosima::fastrtps::rtps::REMOVED_MATCHING == matchingInfo.status) {
-      publishers_.erase(matchingInfo.remoteEndpointGuid);
-    } else {
+    request = &insertRequest(sequence_number, deadline);
+    request->state = RequestState::pending;
+    request->sent = true;
+  }
+
+  // Only drops requests which timed out, so completed_ is left untouched
+  InFlightRequest &
+  insertRequest(int64_t sequence_number, std::chrono::steady_clock::time_point deadline)
+  RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    if (4 * (in_flight_count_ + 1) > 3 * in_flight_.size()) {
+      makeRoom();
+    }
+    size_t index = homeSlot(sequence_number, in_flight_.size());
+    while (in_flight_[index].sequence_number != 0) {
+      index = (index + 1) % in_flight_.size();
+    }
+    InFlightRequest & request = in_flight_[index];
+    request.sequence_number = sequence_number;
+    request.deadline = deadline;
+    ++in_flight_count_;
+    expireAt(deadline);
+    return request;
+  }
+
+  // Drop the requests which timed out, then grow the table if it is still too full
+  void
+  makeRoom() RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    for (size_t index = 0; index < in_flight_.size(); ) {
+      if (RequestState::timed_out == in_flight_[index].state) {
+        // Another request may be moved to the slot
+        eraseRequest(in_flight_[index]);
+      } else {
+        ++index;
+      }
+    }
+    if (4 * (in_flight_count_ + 1) <= 3 * in_flight_.size()) {
       return;
     }
-    info_->response_subscriber_matched_count_.store(publishers_.size());
+    std::vector<InFlightRequest> in_flight(2 * in_flight_.size());
+    for (InFlightRequest & request : in_flight_) {
+      if (request.sequence_number == 0) {
+        continue;
+      }
+      size_t index = homeSlot(request.sequence_number, in_flight.size());
+      while (in_flight[index].sequence_number != 0) {
+        index = (index + 1) % in_flight.size();
+      }
+      in_flight[index] = std::move(request);
+    }
+    in_flight_.swap(in_flight);
+  }
+
+  // Free the slot of a request, the requests probed after it are moved back to keep them found
+  void
+  eraseRequest(InFlightRequest & request) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    if (RequestState::completed == request.state) {
+      request.response.buffer_.reset();
+      if (--completed_count_ == 0) {
+        // Only responses taken by sequence number, or dropped, are left
+        while (!completed_.empty()) {
+          completed_.pop_front();
+        }
+      }
+      list_has_data_.store(completed_count_ > 0);
+    }
+    --in_flight_count_;
+
+    const size_t capacity = in_flight_.size();
+    size_t hole = static_cast<size_t>(&request - in_flight_.data());
+    size_t index = hole;
+    while (true) {
+      index = (index + 1) % capacity;
+      if (in_flight_[index].sequence_number == 0) {
+        break;
+      }
+      size_t home = homeSlot(in_flight_[index].sequence_number, capacity);
+      // Move the request back unless its home slot is after the hole, cyclically
+      bool home_after_hole = hole <= index ?
+        (hole < home && home <= index) : (hole < home || home <= index);
+      if (!home_after_hole) {
+        in_flight_[hole] = std::move(in_flight_[index]);
+        hole = index;
+      }
+    }
+    InFlightRequest & freed = in_flight_[hole];
+    freed.sequence_number = 0;
+    freed.state = RequestState::unknown;
+    freed.sent = false;
+    freed.response.buffer_.reset();
+  }
+
+  void
+  expireAt(std::chrono::steady_clock::time_point deadline) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    if (deadline < next_expiry_) {
+      next_expiry_ = deadline;
+    }
+  }
+
+  // Mark the pending requests which timed out, and drop the responses to requests never sent
+  void
+  purgeExpired(std::chrono::steady_clock::time_point now) RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    if (now < next_expiry_) {
+      return;
+    }
+    next_expiry_ = std::chrono::steady_clock::time_point::max();
+    for (size_t index = 0; index < in_flight_.size(); ) {
+      InFlightRequest & request = in_flight_[index];
+      if (request.sequence_number == 0 || !canExpire(request)) {
+        ++index;
+      } else if (now < request.deadline) {
+        expireAt(request.deadline);
+        ++index;
+      } else if (RequestState::pending == request.state) {
+        request.state = RequestState::timed_out;
+        ++index;
+      } else {
+        // Another request may be moved to the slot
+        eraseRequest(request);
+      }
+    }
   }
 
-private:
   bool popResponse(CustomClientResponse & response) RCPPUTILS_TSA_REQUIRES(internalMutex_)
   {
-    if (!list.empty()) {
-      response = std::move(list.front());
-      list.pop_front();
-      list_has_data_.store(!list.empty());
-      return true;
+    purgeExpired(std::chrono::steady_clock::now());
+    while (!completed_.empty()) {
+      InFlightRequest * request = findRequest(completed_.front());
+      completed_.pop_front();
+      // Skip the responses which were taken by sequence number, or dropped
+      if (request != nullptr && RequestState::completed == request->state) {
+        response = std::move(request->response);
+        eraseRequest(*request);
+        return true;
+      }
     }
     return false;
-  };
+  }
+
+  RequestState popResponse(int64_t sequence_number, CustomClientResponse & response)
+  RCPPUTILS_TSA_REQUIRES(internalMutex_)
+  {
+    auto now = std::chrono::steady_clock::now();
+    purgeExpired(now);
+    InFlightRequest * request = findRequest(sequence_number);
+    if (request == nullptr) {
+      return RequestState::unknown;
+    }
+    RequestState state = request->state;
+    if (RequestState::pending == state) {
+      if (isPending(*request, now)) {
+        return RequestState::pending;
+      }
+      state = RequestState::timed_out;
+    }
+    if (RequestState::completed == state) {
+      response = std::move(request->response);
+    }
+    eraseRequest(*request);
+    return state;
+  }
 
   CustomClientInfo * info_;
+  std::mutex availabilityMutex_;
+  size_t request_subscribers_ RCPPUTILS_TSA_GUARDED_BY(availabilityMutex_);
+  size_t response_publishers_ RCPPUTILS_TSA_GUARDED_BY(availabilityMutex_);
   std::mutex internalMutex_;
-  std::list<CustomClientResponse> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Open addressed with linear probing from the sequence number modulo the size
+  std::vector<InFlightRequest> in_flight_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  size_t in_flight_count_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  int64_t last_sequence_number_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Earliest deadline of the requests which can expire
+  std::chrono::steady_clock::time_point next_expiry_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  // Sequence numbers of the completed requests, in order of arrival of their responses
+  rmw_fastrtps_shared_cpp::RingBuffer<int64_t> completed_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  size_t completed_count_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::atomic_bool list_has_data_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::set<eprosima::fastrtps::rtps::GUID_t> publishers_;
+  rmw_fastrtps_shared_cpp::ReadyList * readyList_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyListEntry readyListEntry_;
 };
 
 class ClientPubListener : public eprosima::fastrtps::PublisherListener
@@ -205,7 +589,7 @@ public:
     } else {
       return;
     }
-    info_->request_publisher_matched_count_.store(subscriptions_.size());
+    info_->listener_->requestSubscribersMatched(subscriptions_.size());
   }
 
 private:
@@ -33,6 +33,7 @@
 
 #include "rmw/event.h"
 
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 
@@ -43,9 +44,16 @@ protected:
 
 public:
   /// Connect a condition variable so a waiter can be notified of new data.
+  /**
+    * \param conditionMutex The mutex to hold while changing state observed by the waiter, or
+    *   nullptr if the waiter parks on readyList instead.
+    * \param conditionVariable The condition variable to notify, or nullptr.
+    * \param readyList The list to push getReadyListEntry() onto when new data is available.
+    */
   virtual void attachCondition(
     std::mutex * conditionMutex,
-    std::condition_variable * conditionVariable) = 0;
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList) = 0;
 
   /// Unset the information from attachCondition.
   virtual void detachCondition() = 0;
@@ -65,6 +73,9 @@ public:
     * \return `false` if data was not available, in this case nothing was written to event_info.
     */
   virtual bool takeNextEvent(rmw_event_type_t event_type, void * event_info) = 0;
+
+  /// Entry identifying this listener on the ready list of a wait set.
+  virtual rmw_fastrtps_shared_cpp::ReadyListEntry * getReadyListEntry() = 0;
 };
 
 class EventListenerInterface::ConditionalScopedLock
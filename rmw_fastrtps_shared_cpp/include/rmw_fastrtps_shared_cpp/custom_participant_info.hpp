@@ -15,14 +15,17 @@
 #ifndef RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 #define RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
 
-#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "fastrtps/attributes/ParticipantAttributes.h"
 #include "fastrtps/participant/Participant.h"
 #include "fastrtps/participant/ParticipantListener.h"
+#include "fastrtps/publisher/Publisher.h"
 
 #include "rcpputils/thread_safety_annotations.hpp"
 #include "rcutils/logging_macros.h"
@@ -30,17 +33,33 @@
 #include "rmw/impl/cpp/key_value.hpp"
 #include "rmw/rmw.h"
 
+#include "graph_cache.hpp"
 #include "rmw_common.hpp"
-
-#include "topic_cache.hpp"
+#include "rmw_context_impl.hpp"
 
 class ParticipantListener;
 
 typedef struct CustomParticipantInfo
 {
+  // Participant and listener are shared by all the nodes of the context which were created
+  // with the same domain id and options, see rmw_context_impl_t.
   eprosima::fastrtps::Participant * participant;
   ::ParticipantListener * listener;
+  // Graph of the domain, shared by all the participants of the process in the domain
+  std::shared_ptr<GraphCache> graph_cache;
+  // Response readers of the clients of the participant, shared by all its nodes
+  std::shared_ptr<rmw_fastrtps_shared_cpp::ResponseReaders> response_readers;
   rmw_guard_condition_t * graph_guard_condition;
+  rmw_context_impl_t * context_impl;
+
+  // Key of this node in graph_cache
+  eprosima::fastrtps::rtps::GUID_t node_guid;
+  // User data of the endpoints of this node, which tells other participants what node they
+  // belong to, as the participant user data can only name one node.
+  std::vector<eprosima::fastrtps::rtps::octet> node_user_data;
+  // Publisher which is never written to, so other participants discover this node even when
+  // it has no other endpoint
+  eprosima::fastrtps::Publisher * node_announcement;
 
   // Flag to establish if the QoS of the participant,
   // its publishers and its subscribers are going
@@ -53,10 +72,27 @@ typedef struct CustomParticipantInfo
 class ParticipantListener : public eprosima::fastrtps::ParticipantListener
 {
 public:
-  explicit ParticipantListener(rmw_guard_condition_t * graph_guard_condition)
-  : graph_guard_condition_(graph_guard_condition)
+  explicit ParticipantListener(std::shared_ptr<GraphCache> graph_cache)
+  : graph_cache_(std::move(graph_cache))
   {}
 
+  ~ParticipantListener()
+  {
+    // Withdraw what this participant reported, other participants of the process may still
+    // report the same entities.
+    std::lock_guard<std::mutex> guard(mutex_);
+    bool trigger = false;
+    for (const auto & endpoint_guid : endpoints_) {
+      trigger |= graph_cache_->remove_endpoint(endpoint_guid);
+    }
+    for (const auto & participant_guid : participants_) {
+      graph_cache_->remove_participant(participant_guid);
+    }
+    if (trigger) {
+      graph_cache_->trigger_graph_guard_conditions();
+    }
+  }
+
   void onParticipantDiscovery(
     eprosima::fastrtps::Participant *,
     eprosima::fastrtps::rtps::ParticipantDiscoveryInfo && info) override
@@ -69,20 +105,24 @@ public:
       return;
     }
 
-    std::lock_guard<std::mutex> guard(names_mutex_);
+    std::lock_guard<std::mutex> guard(mutex_);
     if (eprosima::fastrtps::rtps::ParticipantDiscoveryInfo::DISCOVERED_PARTICIPANT == info.status) {
       // ignore already known GUIDs
-      if (discovered_names.find(info.info.m_guid) == discovered_names.end()) {
-        auto map = rmw::impl::cpp::parse_key_value(info.info.m_userData);
+      if (!participants_.insert(info.info.m_guid).second) {
+        return;
+      }
+      auto map = rmw::impl::cpp::parse_key_value(info.info.m_userData);
+      std::string name;
+      std::string namespace_;
+      // participants shared by several nodes name them in the user data of their endpoints
+      if (map.find("nodes") == map.end()) {
         auto name_found = map.find("name");
         auto ns_found = map.find("namespace");
 
-        std::string name;
         if (name_found != map.end()) {
           name = std::string(name_found->second.begin(), name_found->second.end());
         }
 
-        std::string namespace_;
         if (ns_found != map.end()) {
           namespace_ = std::string(ns_found->second.begin(), ns_found->second.end());
         }
@@ -91,52 +131,17 @@ public:
           // use participant name if no name was found in the user data
           name = info.info.m_participantName;
         }
-        // ignore discovered participants without a name
-        if (!name.empty()) {
-          discovered_names[info.info.m_guid] = name;
-          discovered_namespaces[info.info.m_guid] = namespace_;
-        }
       }
+      // discovered participants without a name are not listed as nodes
+      graph_cache_->add_participant(info.info.m_guid, name, namespace_);
     } else {
-      {
-        auto it = discovered_names.find(info.info.m_guid);
-        // only consider known GUIDs
-        if (it != discovered_names.end()) {
-          discovered_names.erase(it);
-        }
-      }
-      {
-        auto it = discovered_namespaces.find(info.info.m_guid);
-        // only consider known GUIDs
-        if (it != discovered_namespaces.end()) {
-          discovered_namespaces.erase(it);
-        }
+      // only consider known GUIDs
+      if (participants_.erase(info.info.m_guid) > 0) {
+        graph_cache_->remove_participant(info.info.m_guid);
       }
     }
   }
 
-  std::vector<std::string> get_discovered_names() const
-  {
-    std::lock_guard<std::mutex> guard(names_mutex_);
-    std::vector<std::string> names(discovered_names.size());
-    size_t i = 0;
-    for (auto it : discovered_names) {
-      names[i++] = it.second;
-    }
-    return names;
-  }
-
-  std::vector<std::string> get_discovered_namespaces() const
-  {
-    std::lock_guard<std::mutex> guard(names_mutex_);
-    std::vector<std::string> namespaces(discovered_namespaces.size());
-    size_t i = 0;
-    for (auto it : discovered_namespaces) {
-      namespaces[i++] = it.second;
-    }
-    return namespaces;
-  }
-
   void onSubscriberDiscovery(
     eprosima::fastrtps::Participant *,
     eprosima::fastrtps::rtps::ReaderDiscoveryInfo && info) override
@@ -162,40 +167,40 @@ public:
   template<class T>
   void process_discovery_info(T & proxyData, bool is_alive, bool is_reader)
   {
-    auto & topic_cache =
-      is_reader ? reader_topic_cache : writer_topic_cache;
     bool trigger;
     {
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      std::lock_guard<std::mutex> guard(mutex_);
       if (is_alive) {
-        trigger = topic_cache().addTopic(
-          proxyData.RTPSParticipantKey(),
+        if (!endpoints_.insert(proxyData.guid()).second) {
+          return;
+        }
+        trigger = graph_cache_->add_endpoint(
+          iHandle2GUID(proxyData.RTPSParticipantKey()),
           proxyData.guid(),
-          proxyData.topicName().to_string(),
-          proxyData.typeName().to_string(),
-          proxyData.m_qos);
+          InternedString(proxyData.topicName().c_str()),
+          InternedString(proxyData.typeName().c_str()),
+          proxyData.m_qos,
+          proxyData.m_qos.m_userData.getDataVec(),
+          is_reader);
       } else {
-        trigger = topic_cache().removeTopic(
-          proxyData.RTPSParticipantKey(),
-          proxyData.guid(),
-          proxyData.topicName().to_string(),
-          proxyData.typeName().to_string());
+        if (endpoints_.erase(proxyData.guid()) == 0) {
+          return;
+        }
+        trigger = graph_cache_->remove_endpoint(proxyData.guid());
       }
     }
     if (trigger) {
-      rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
-        graph_guard_condition_->implementation_identifier,
-        graph_guard_condition_);
+      graph_cache_->trigger_graph_guard_conditions();
     }
   }
 
-  using guid_map_t = std::map<eprosima::fastrtps::rtps::GUID_t, std::string>;
-  mutable std::mutex names_mutex_;
-  guid_map_t discovered_names RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
-  guid_map_t discovered_namespaces RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
-  LockedObject<TopicCache> reader_topic_cache;
-  LockedObject<TopicCache> writer_topic_cache;
-  rmw_guard_condition_t * graph_guard_condition_;
+private:
+  std::shared_ptr<GraphCache> graph_cache_;
+
+  // Entities this participant reported to graph_cache_
+  std::mutex mutex_;
+  std::set<GUID_t> participants_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  std::set<GUID_t> endpoints_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_PARTICIPANT_INFO_HPP_
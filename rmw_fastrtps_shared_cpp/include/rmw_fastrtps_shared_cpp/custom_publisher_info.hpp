@@ -18,6 +18,7 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
 #include <set>
 
 #include "fastrtps/publisher/Publisher.h"
@@ -28,6 +29,7 @@
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
 
 
 class PubListener;
@@ -42,6 +44,8 @@ typedef struct CustomPublisherInfo : public CustomEventInfo
   const void * type_support_impl_;
   rmw_gid_t publisher_gid;
   const char * typesupport_identifier_;
+  // Messages loaned to the user, only set for types which can be loaned
+  std::unique_ptr<rmw_fastrtps_shared_cpp::LoanedMessagePool> loan_pool_;
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   EventListenerInterface *
@@ -55,7 +59,8 @@ public:
   : deadline_changes_(false),
     liveliness_changes_(false),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
+    conditionVariable_(nullptr),
+    readyList_(nullptr)
   {
     (void) info;
   }
@@ -97,6 +102,12 @@ public:
   bool
   takeNextEvent(rmw_event_type_t event_type, void * event_info) final;
 
+  rmw_fastrtps_shared_cpp::ReadyListEntry *
+  getReadyListEntry() final
+  {
+    return &readyListEntry_;
+  }
+
   // PubListener API
   size_t subscriptionCount()
   {
@@ -105,19 +116,24 @@ public:
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyList_ = readyList;
   }
 
   void
-  detachCondition()
+  detachCondition() final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyList_ = nullptr;
   }
 
 private:
@@ -136,6 +152,8 @@ private:
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyList * readyList_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyListEntry readyListEntry_;
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_PUBLISHER_INFO_HPP_
@@ -17,7 +17,6 @@
 
 #include <atomic>
 #include <condition_variable>
-#include <list>
 #include <mutex>
 
 #include "fastcdr/FastBuffer.h"
@@ -31,6 +30,7 @@
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
 class ServiceListener;
@@ -48,92 +48,89 @@ typedef struct CustomServiceInfo
   const char * typesupport_identifier_;
 } CustomServiceInfo;
 
-typedef struct CustomServiceRequest
-{
-  eprosima::fastrtps::rtps::SampleIdentity sample_identity_;
-  eprosima::fastcdr::FastBuffer * buffer_;
-
-  CustomServiceRequest()
-  : buffer_(nullptr) {}
-} CustomServiceRequest;
-
+/// Readiness of the requests received by a service.
+/**
+ * Requests stay in the history of the request reader until they are taken, so
+ * __rmw_take_request deserializes them straight from there, and how many of them are kept is
+ * given by the history QoS of the reader.
+ */
 class ServiceListener : public eprosima::fastrtps::SubscriberListener
 {
 public:
   explicit ServiceListener(CustomServiceInfo * info)
-  : info_(info), list_has_data_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr)
+  : data_(0),
+    conditionMutex_(nullptr), conditionVariable_(nullptr), readyList_(nullptr)
   {
-    (void)info_;
+    // Field is not used right now
+    (void)info;
   }
 
-
   void
   onNewDataMessage(eprosima::fastrtps::Subscriber * sub)
   {
     assert(sub);
 
-    CustomServiceRequest request;
-    request.buffer_ = new eprosima::fastcdr::FastBuffer();
-    eprosima::fastrtps::SampleInfo_t sinfo;
-
-    rmw_fastrtps_shared_cpp::SerializedData data;
-    data.is_cdr_buffer = true;
-    data.data = request.buffer_;
-    data.impl = nullptr;    // not used when is_cdr_buffer is true
-    if (sub->takeNextData(&data, &sinfo)) {
-      if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-        request.sample_identity_ = sinfo.sample_identity;
-
-        std::lock_guard<std::mutex> lock(internalMutex_);
-
-        if (conditionMutex_ != nullptr) {
-          std::unique_lock<std::mutex> clock(*conditionMutex_);
-          list.push_back(request);
-          // the change to list_has_data_ needs to be mutually exclusive with
-          // rmw_wait() which checks hasData() and decides if wait() needs to
-          // be called
-          list_has_data_.store(true);
-          clock.unlock();
-          conditionVariable_->notify_one();
-        } else {
-          list.push_back(request);
-          list_has_data_.store(true);
-        }
+    // Make sure to call into Fast-RTPS before taking the lock to avoid an
+    // ABBA deadlock between internalMutex_ and mutexes inside of Fast-RTPS.
+#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
+    uint64_t unread_count = sub->getUnreadCount();
+#else
+    uint64_t unread_count = sub->get_unread_count();
+#endif
+
+    std::lock_guard<std::mutex> lock(internalMutex_);
+
+    if (conditionMutex_ != nullptr) {
+      std::unique_lock<std::mutex> clock(*conditionMutex_);
+      // the change to data_ needs to be mutually exclusive with
+      // rmw_wait() which checks hasData() and decides if wait() needs to
+      // be called
+      data_.store(unread_count);
+      if (unread_count > 0) {
+        readyList_->push(&readyListEntry_);
+      }
+      clock.unlock();
+      conditionVariable_->notify_one();
+    } else {
+      data_.store(unread_count);
+      if (readyList_ != nullptr && unread_count > 0) {
+        // Attached to a wait set which parks on its ready list
+        readyList_->push(&readyListEntry_);
       }
     }
   }
 
-  CustomServiceRequest
-  getRequest()
+  void
+  data_taken(eprosima::fastrtps::Subscriber * sub)
   {
+    // Make sure to call into Fast-RTPS before taking the lock to avoid an
+    // ABBA deadlock between internalMutex_ and mutexes inside of Fast-RTPS.
+#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
+    uint64_t unread_count = sub->getUnreadCount();
+#else
+    uint64_t unread_count = sub->get_unread_count();
+#endif
+
     std::lock_guard<std::mutex> lock(internalMutex_);
-    CustomServiceRequest request;
 
     if (conditionMutex_ != nullptr) {
       std::unique_lock<std::mutex> clock(*conditionMutex_);
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
-      }
+      data_.store(unread_count);
     } else {
-      if (!list.empty()) {
-        request = list.front();
-        list.pop_front();
-        list_has_data_.store(!list.empty());
-      }
+      data_.store(unread_count);
     }
-
-    return request;
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyList_ = readyList;
   }
 
   void
@@ -142,21 +139,29 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyList_ = nullptr;
+  }
+
+  rmw_fastrtps_shared_cpp::ReadyListEntry *
+  getReadyListEntry()
+  {
+    return &readyListEntry_;
   }
 
   bool
   hasData()
   {
-    return list_has_data_.load();
+    return data_.load() > 0;
   }
 
 private:
-  CustomServiceInfo * info_;
   std::mutex internalMutex_;
-  std::list<CustomServiceRequest> list RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
-  std::atomic_bool list_has_data_;
+  // Number of requests in the reader history which were not taken yet
+  std::atomic_size_t data_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyList * readyList_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyListEntry readyListEntry_;
 };
 
 #endif  // RMW_FASTRTPS_SHARED_CPP__CUSTOM_SERVICE_INFO_HPP_
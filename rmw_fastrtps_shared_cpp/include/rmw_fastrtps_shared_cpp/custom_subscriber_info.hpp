@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <utility>
@@ -30,6 +31,7 @@
 
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
 
 
 class SubListener;
@@ -43,6 +45,8 @@ typedef struct CustomSubscriberInfo : public CustomEventInfo
   rmw_fastrtps_shared_cpp::TypeSupport * type_support_;
   const void * type_support_impl_;
   const char * typesupport_identifier_;
+  // Messages loaned to the user, only set for types which can be loaned
+  std::unique_ptr<rmw_fastrtps_shared_cpp::LoanedMessagePool> loan_pool_;
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
   EventListenerInterface *
@@ -57,7 +61,8 @@ public:
     deadline_changes_(false),
     liveliness_changes_(false),
     conditionMutex_(nullptr),
-    conditionVariable_(nullptr)
+    conditionVariable_(nullptr),
+    readyList_(nullptr)
   {
     // Field is not used right now
     (void)info;
@@ -94,6 +99,9 @@ public:
     ConditionalScopedLock clock(conditionMutex_, conditionVariable_);
 
     data_.store(unread_count, std::memory_order_relaxed);
+    if (readyList_ != nullptr && unread_count > 0) {
+      readyList_->push(&readyListEntry_);
+    }
   }
 
   RMW_FASTRTPS_SHARED_CPP_PUBLIC
@@ -117,21 +125,32 @@ public:
   bool
   takeNextEvent(rmw_event_type_t event_type, void * event_info) final;
 
+  rmw_fastrtps_shared_cpp::ReadyListEntry *
+  getReadyListEntry() final
+  {
+    return &readyListEntry_;
+  }
+
   // SubListener API
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList) final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyList_ = readyList;
   }
 
   void
-  detachCondition()
+  detachCondition() final
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyList_ = nullptr;
   }
 
   bool
@@ -177,6 +196,8 @@ private:
 
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyList * readyList_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyListEntry readyListEntry_;
 
   std::set<eprosima::fastrtps::rtps::GUID_t> publishers_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
 };
@@ -0,0 +1,465 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__GRAPH_CACHE_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__GRAPH_CACHE_HPP_
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fastrtps/rtps/common/Guid.h"
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw/impl/cpp/key_value.hpp"
+#include "rmw/rmw.h"
+
+#include "interned_string.hpp"
+#include "rmw_common.hpp"
+#include "shared_mutex.hpp"
+#include "topic_cache.hpp"
+#include "visibility_control.h"
+
+/// Topic of the publishers which only announce a node, so nodes without endpoints are discovered.
+constexpr const char * node_announcement_topic_name = "ros_node_announcement";
+
+/**
+ * Graph of the ROS nodes, topics and services discovered in a domain.
+ *
+ * A single instance is shared by all the participants of the process in the same domain, so the
+ * graph is stored once no matter how many contexts and nodes the process has.
+ * Every participant reports what it discovers; an entity discovered by several participants is
+ * only added on the first report and removed on the last one.
+ */
+class GraphCache
+{
+public:
+  GraphCache()
+  : next_node_id_(1)
+  {}
+
+  GraphCache(const GraphCache &) = delete;
+  GraphCache & operator=(const GraphCache &) = delete;
+
+  /// Return the graph cache of the participants of this process in a domain.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  static std::shared_ptr<GraphCache>
+  get_for_domain(size_t domain_id, bool localhost_only);
+
+  /// Count one more participant reporting a remote participant.
+  /**
+   * \param guid of the remote participant
+   * \param name of the node of the participant, or empty if it is not a node
+   * \param namespace_ of the node of the participant
+   */
+  void add_participant(
+    const GUID_t & guid,
+    const std::string & name,
+    const std::string & namespace_)
+  {
+    std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    if (participant_ref_counts_[guid]++ > 0) {
+      return;
+    }
+    if (!name.empty()) {
+      add_name(guid, name, namespace_);
+    }
+  }
+
+  /// Count one less participant reporting a remote participant, forget it with the last one.
+  void remove_participant(const GUID_t & guid)
+  {
+    std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    auto count = participant_ref_counts_.find(guid);
+    if (count == participant_ref_counts_.end() || --count->second > 0) {
+      return;
+    }
+    participant_ref_counts_.erase(count);
+    remove_name(guid);
+    // forget the nodes of the participant, in case it went away without removing its endpoints
+    for (auto it = node_refs_.begin(); it != node_refs_.end(); ) {
+      if (it->first.guidPrefix == guid.guidPrefix) {
+        remove_name(it->first);
+        node_guids_.erase(it->second.key);
+        it = node_refs_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  /// Count one more participant reporting a publisher or subscription.
+  /**
+   * Endpoints are listed under the node named in their user data, if any, and under their
+   * participant otherwise. Node announcements only count as a reference to their node.
+   *
+   * \return true if the graph changed
+   */
+  template<class T>
+  bool add_endpoint(
+    const GUID_t & participant_guid,
+    const GUID_t & endpoint_guid,
+    const InternedString & topic_name,
+    const InternedString & type_name,
+    const T & dds_qos,
+    const std::vector<eprosima::fastrtps::rtps::octet> & user_data,
+    bool is_reader)
+  {
+    std::lock_guard<std::mutex> endpoints_guard(endpoints_mutex_);
+    auto it = endpoints_.find(endpoint_guid);
+    if (it != endpoints_.end()) {
+      ++it->second.ref_count;
+      return false;
+    }
+    GUID_t owner_guid = participant_guid;
+    auto map = rmw::impl::cpp::parse_key_value(user_data);
+    auto name_found = map.find("name");
+    auto ns_found = map.find("namespace");
+    if (name_found != map.end() && ns_found != map.end()) {
+      std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+      owner_guid = acquire_node(
+        participant_guid,
+        std::string(name_found->second.begin(), name_found->second.end()),
+        std::string(ns_found->second.begin(), ns_found->second.end()));
+    }
+    bool announces_node = is_node_announcement(topic_name);
+    endpoints_[endpoint_guid] =
+      {1u, is_reader, announces_node, participant_guid, owner_guid, topic_name, type_name};
+    if (announces_node) {
+      return owner_guid != participant_guid;
+    }
+
+    auto & topic_cache = is_reader ? reader_topic_cache : writer_topic_cache;
+    std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(topic_cache.getMutex());
+    return topic_cache().addTopic(owner_guid, endpoint_guid, topic_name, type_name, dds_qos);
+  }
+
+  /// Count one less participant reporting a publisher or subscription, remove it with the last.
+  /**
+   * \return true if the graph changed
+   */
+  bool remove_endpoint(const GUID_t & endpoint_guid)
+  {
+    std::lock_guard<std::mutex> endpoints_guard(endpoints_mutex_);
+    auto it = endpoints_.find(endpoint_guid);
+    if (it == endpoints_.end() || --it->second.ref_count > 0) {
+      return false;
+    }
+    EndpointInfo endpoint = it->second;
+    endpoints_.erase(it);
+
+    bool changed = endpoint.announces_node;
+    if (!endpoint.announces_node) {
+      auto & topic_cache = endpoint.is_reader ? reader_topic_cache : writer_topic_cache;
+      std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(topic_cache.getMutex());
+      changed = topic_cache().removeTopic(
+        endpoint.owner_guid, endpoint_guid, endpoint.topic_name, endpoint.type_name);
+    }
+    if (endpoint.owner_guid != endpoint.participant_guid) {
+      std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+      release_node(endpoint.owner_guid);
+    }
+    return changed;
+  }
+
+  /// Register a node created on a participant of this process.
+  /**
+   * \return the key of the node in the graph caches
+   */
+  GUID_t add_local_node(
+    const GUID_t & participant_guid,
+    const std::string & name,
+    const std::string & namespace_)
+  {
+    std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    return acquire_node(participant_guid, name, namespace_);
+  }
+
+  void remove_local_node(const GUID_t & node_guid)
+  {
+    std::lock_guard<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    release_node(node_guid);
+  }
+
+  void add_graph_guard_condition(rmw_guard_condition_t * graph_guard_condition)
+  {
+    std::lock_guard<std::mutex> guard(graph_guard_conditions_mutex_);
+    graph_guard_conditions_.push_back(graph_guard_condition);
+  }
+
+  void remove_graph_guard_condition(rmw_guard_condition_t * graph_guard_condition)
+  {
+    std::lock_guard<std::mutex> guard(graph_guard_conditions_mutex_);
+    graph_guard_conditions_.erase(
+      std::remove(
+        graph_guard_conditions_.begin(), graph_guard_conditions_.end(), graph_guard_condition),
+      graph_guard_conditions_.end());
+  }
+
+  /// Trigger the graph guard condition of every node of the process in the domain.
+  void trigger_graph_guard_conditions()
+  {
+    std::lock_guard<std::mutex> guard(graph_guard_conditions_mutex_);
+    for (rmw_guard_condition_t * graph_guard_condition : graph_guard_conditions_) {
+      rmw_fastrtps_shared_cpp::__rmw_trigger_guard_condition(
+        graph_guard_condition->implementation_identifier,
+        graph_guard_condition);
+    }
+  }
+
+  /// Find the key of a node in the graph caches by name.
+  /**
+   * When several nodes have the same name, the one with the lowest key is found.
+   *
+   * \return true if a node has the name
+   */
+  bool get_node_guid(
+    const std::string & name,
+    const std::string & namespace_,
+    GUID_t & guid) const
+  {
+    // A name which is not interned is not the one of any node.
+    // Look the names up before taking the lock, not to hold it while waiting for the interner.
+    InternedString interned_name;
+    InternedString interned_namespace;
+    if (
+      !InternedString::find(name, interned_name) ||
+      !InternedString::find(namespace_, interned_namespace))
+    {
+      return false;
+    }
+    std::shared_lock<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    auto it = guids_by_name_.find(std::make_pair(interned_namespace, interned_name));
+    if (it == guids_by_name_.end()) {
+      return false;
+    }
+    guid = *it->second.begin();
+    return true;
+  }
+
+  /// Find the name and namespace of a node or participant by its key in the graph caches.
+  /**
+   * \return true if the key is the one of a named node
+   */
+  bool get_node_name(
+    const GUID_t & guid,
+    std::string & name,
+    std::string & namespace_) const
+  {
+    std::shared_lock<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    auto it = node_indices_.find(guid);
+    if (it == node_indices_.end()) {
+      return false;
+    }
+    const NodeRecord & node = nodes_[it->second];
+    name = node.name;
+    namespace_ = node.namespace_;
+    return true;
+  }
+
+  struct DiscoveredNode
+  {
+    GUID_t guid;
+    std::string name;
+    std::string namespace_;
+  };
+
+  /// Return the nodes of the domain, the ones of this process included, in no particular order.
+  std::vector<DiscoveredNode> get_discovered_nodes() const
+  {
+    std::shared_lock<rmw_fastrtps_shared_cpp::SharedMutex> guard(names_mutex_);
+    std::vector<DiscoveredNode> nodes;
+    nodes.reserve(nodes_.size());
+    for (const NodeRecord & node : nodes_) {
+      nodes.push_back({node.guid, node.name, node.namespace_});
+    }
+    return nodes;
+  }
+
+  LockedObject<TopicCache> reader_topic_cache;
+  LockedObject<TopicCache> writer_topic_cache;
+
+private:
+  struct EndpointInfo
+  {
+    // Number of participants of the process which reported the endpoint
+    size_t ref_count;
+    bool is_reader;
+    // Whether the endpoint is a node announcement, which is not listed in the topic cache
+    bool announces_node;
+    GUID_t participant_guid;
+    // Node the endpoint is listed under in the topic cache, or participant_guid
+    GUID_t owner_guid;
+    InternedString topic_name;
+    InternedString type_name;
+  };
+
+  static bool is_node_announcement(const InternedString & topic_name)
+  {
+    static const InternedString announcement_topic_name(node_announcement_topic_name);
+    return topic_name == announcement_topic_name;
+  }
+
+  /// Return the key of a node, and count one more reference to it.
+  /**
+   * Nodes are keyed by the GUID prefix of their participant and an entity id of kind 0x00
+   * (user defined, unknown), which no publisher or subscription uses.
+   */
+  GUID_t acquire_node(
+    const GUID_t & participant_guid,
+    const InternedString & name,
+    const InternedString & namespace_) RCPPUTILS_TSA_REQUIRES(names_mutex_)
+  {
+    auto key = std::make_tuple(participant_guid, name, namespace_);
+    auto it = node_guids_.find(key);
+    if (it == node_guids_.end()) {
+      GUID_t node_guid;
+      node_guid.guidPrefix = participant_guid.guidPrefix;
+      using eprosima::fastrtps::rtps::octet;
+      node_guid.entityId.value[0] = static_cast<octet>(next_node_id_ >> 16);
+      node_guid.entityId.value[1] = static_cast<octet>(next_node_id_ >> 8);
+      node_guid.entityId.value[2] = static_cast<octet>(next_node_id_);
+      node_guid.entityId.value[3] = 0x00;
+      ++next_node_id_;
+      it = node_guids_.emplace(key, node_guid).first;
+      node_refs_.emplace(node_guid, NodeRef {key, 0u});
+      add_name(node_guid, name, namespace_);
+    }
+    ++node_refs_[it->second].ref_count;
+    return it->second;
+  }
+
+  void add_name(
+    const GUID_t & guid,
+    const InternedString & name,
+    const InternedString & namespace_) RCPPUTILS_TSA_REQUIRES(names_mutex_)
+  {
+    remove_name(guid);
+    NodeRecord node {guid, name, namespace_};
+    node_indices_.emplace(guid, nodes_.size());
+    nodes_.push_back(node);
+    guids_by_name_[std::make_pair(node.namespace_, node.name)].insert(guid);
+  }
+
+  void remove_name(const GUID_t & guid) RCPPUTILS_TSA_REQUIRES(names_mutex_)
+  {
+    auto index = node_indices_.find(guid);
+    if (index == node_indices_.end()) {
+      return;
+    }
+    NodeRecord node = nodes_[index->second];
+    auto guids = guids_by_name_.find(std::make_pair(node.namespace_, node.name));
+    guids->second.erase(guid);
+    if (guids->second.empty()) {
+      guids_by_name_.erase(guids);
+    }
+    // Fill the hole with the last node rather than shifting the ones after it
+    if (index->second != nodes_.size() - 1) {
+      nodes_[index->second] = nodes_.back();
+      node_indices_[nodes_[index->second].guid] = index->second;
+    }
+    nodes_.pop_back();
+    node_indices_.erase(index);
+  }
+
+  /// Drop one reference to a node, and forget about it once unreferenced.
+  void release_node(const GUID_t & node_guid) RCPPUTILS_TSA_REQUIRES(names_mutex_)
+  {
+    auto ref = node_refs_.find(node_guid);
+    if (ref == node_refs_.end() || --ref->second.ref_count > 0) {
+      return;
+    }
+    remove_name(node_guid);
+    node_guids_.erase(ref->second.key);
+    node_refs_.erase(ref);
+  }
+
+  // Serializes endpoint additions and removals, taken before names_mutex_ and the topic caches
+  std::mutex endpoints_mutex_;
+  std::map<GUID_t, EndpointInfo> endpoints_ RCPPUTILS_TSA_GUARDED_BY(endpoints_mutex_);
+
+  // Locked shared by queries, and exclusively by updates
+  mutable rmw_fastrtps_shared_cpp::SharedMutex names_mutex_;
+  // Number of participants of the process which reported each remote participant
+  std::map<GUID_t, size_t> participant_ref_counts_ RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+  // Participant GUID, name and namespace of a node
+  using NodeKey = std::tuple<GUID_t, InternedString, InternedString>;
+  struct NodeKeyHash
+  {
+    size_t operator()(const NodeKey & key) const
+    {
+      auto combine = [](size_t hash, size_t value) {
+          return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+        };
+      size_t hash = GUIDHash()(std::get<0>(key));
+      hash = combine(hash, std::hash<InternedString>()(std::get<1>(key)));
+      return combine(hash, std::hash<InternedString>()(std::get<2>(key)));
+    }
+  };
+  // Nodes of every known participant, by participant GUID, name and namespace
+  std::unordered_map<NodeKey, GUID_t, NodeKeyHash> node_guids_
+  RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+  struct NodeRef
+  {
+    NodeKey key;
+    // Number of endpoints of the node, plus one for nodes created in this process
+    size_t ref_count;
+  };
+  // Key in node_guids_ and reference count of each node, by node GUID
+  std::unordered_map<GUID_t, NodeRef, GUIDHash> node_refs_
+  RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+  uint32_t next_node_id_ RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+
+  /// Name and namespace of a node, or of a participant which is a node.
+  struct NodeRecord
+  {
+    GUID_t guid;
+    InternedString name;
+    InternedString namespace_;
+  };
+
+  // Named nodes and participants, in no particular order
+  std::vector<NodeRecord> nodes_ RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+  // Index of each node in nodes_, by key
+  std::unordered_map<GUID_t, size_t, GUIDHash> node_indices_
+  RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+
+  struct NameHash
+  {
+    size_t operator()(const std::pair<InternedString, InternedString> & name) const
+    {
+      size_t hash = std::hash<InternedString>()(name.first);
+      size_t name_hash = std::hash<InternedString>()(name.second);
+      return hash ^ (name_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+    }
+  };
+  // Keys of the nodes in nodes_, by namespace and name
+  std::unordered_map<std::pair<InternedString, InternedString>, std::set<GUID_t>, NameHash>
+  guids_by_name_ RCPPUTILS_TSA_GUARDED_BY(names_mutex_);
+
+  std::mutex graph_guard_conditions_mutex_;
+  std::vector<rmw_guard_condition_t *> graph_guard_conditions_
+  RCPPUTILS_TSA_GUARDED_BY(graph_guard_conditions_mutex_);
+};
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__GRAPH_CACHE_HPP_
@@ -0,0 +1,160 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__INTERNED_STRING_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__INTERNED_STRING_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// String stored once in the process, however many times it is used.
+/**
+ * Equal interned strings share the same storage, so they are copied, compared and hashed by
+ * address, which is also their id. An id stays the same for as long as one copy of the string
+ * exists, the string is freed with its last copy.
+ *
+ * Interning a string looks it up in a table shared by the whole process, under a mutex, so
+ * strings should be interned once and copied from then on, not interned again for lookups.
+ */
+class InternedString
+{
+public:
+  /// The empty string.
+  InternedString() = default;
+
+  // Implicit, as std::string is
+  InternedString(const std::string & str)  // NOLINT
+  : InternedString(str.data(), str.size())
+  {}
+
+  InternedString(const char * str)  // NOLINT
+  : InternedString(str, strlen(str))
+  {}
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  InternedString(const char * data, size_t size);
+
+  /// Find the interned string equal to a string, without interning it if there is none.
+  /**
+   * \return true if the string is interned
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  static bool
+  find(const std::string & str, InternedString & interned);
+
+  const std::string &
+  str() const
+  {
+    return string_ ? *string_ : empty_string();
+  }
+
+  operator const std::string &() const
+  {
+    return str();
+  }
+
+  const char *
+  c_str() const
+  {
+    return str().c_str();
+  }
+
+  bool
+  empty() const
+  {
+    return !string_;
+  }
+
+  /// Return the id of the string, equal for equal strings and different otherwise.
+  const void *
+  id() const
+  {
+    return string_.get();
+  }
+
+private:
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  static const std::string &
+  empty_string();
+
+  // nullptr for the empty string
+  std::shared_ptr<const std::string> string_;
+};
+
+inline bool
+operator==(const InternedString & a, const InternedString & b)
+{
+  return a.id() == b.id();
+}
+
+inline bool
+operator!=(const InternedString & a, const InternedString & b)
+{
+  return a.id() != b.id();
+}
+
+inline bool
+operator==(const InternedString & a, const std::string & b)
+{
+  return a.str() == b;
+}
+
+inline bool
+operator==(const std::string & a, const InternedString & b)
+{
+  return a == b.str();
+}
+
+inline bool
+operator==(const InternedString & a, const char * b)
+{
+  return a.str() == b;
+}
+
+inline bool
+operator==(const char * a, const InternedString & b)
+{
+  return a == b.str();
+}
+
+inline std::ostream &
+operator<<(std::ostream & stream, const InternedString & str)
+{
+  return stream << str.str();
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+namespace std
+{
+template<>
+struct hash<rmw_fastrtps_shared_cpp::InternedString>
+{
+  size_t operator()(const rmw_fastrtps_shared_cpp::InternedString & str) const
+  {
+    return hash<const void *>()(str.id());
+  }
+};
+}  // namespace std
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__INTERNED_STRING_HPP_
@@ -0,0 +1,92 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Pool of ROS messages which are loaned to the user by a publisher or a subscription.
+/**
+ * Messages are initialized once when they are allocated and finalized when the pool is
+ * destroyed, so this is only meant for plain types whose messages can be reused as they are.
+ * More messages are allocated when all the preallocated ones are loaned.
+ */
+class LoanedMessagePool
+{
+public:
+  using MessageFunction = std::function<void (void *)>;
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  LoanedMessagePool(
+    size_t message_size,
+    size_t preallocated_count,
+    MessageFunction init_function,
+    MessageFunction fini_function);
+
+  LoanedMessagePool(const LoanedMessagePool &) = delete;
+  LoanedMessagePool & operator=(const LoanedMessagePool &) = delete;
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  ~LoanedMessagePool();
+
+  /// Loan a message.
+  /**
+   * \return the message, or `nullptr` if no message could be allocated.
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void *
+  borrow();
+
+  /// Check whether a message is currently loaned from this pool.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  bool
+  is_loaned(void * message);
+
+  /// Give a loaned message back to the pool.
+  /**
+   * \return `false` if the message does not belong to this pool or is not on loan,
+   *   e.g. because it was already given back.
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  bool
+  give_back(void * message);
+
+private:
+  void *
+  allocate() RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  const size_t message_size_;
+  const MessageFunction init_function_;
+  const MessageFunction fini_function_;
+
+  std::mutex mutex_;
+  // Every message allocated by the pool, mapped to whether it is on loan
+  std::unordered_map<void *, bool> messages_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  std::vector<void *> available_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__LOANED_MESSAGE_POOL_HPP_
@@ -0,0 +1,187 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__READY_LIST_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__READY_LIST_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+class ReadyList;
+
+/// Entry embedded in every entity which can be queued on the ready list of a wait set.
+class ReadyListEntry
+{
+public:
+  ReadyListEntry()
+  : queued_in_(nullptr), next_(nullptr), owner_(nullptr) {}
+
+  ReadyListEntry(const ReadyListEntry &) = delete;
+  ReadyListEntry & operator=(const ReadyListEntry &) = delete;
+
+  /// Next entry of a list returned by ReadyList::take_all().
+  ReadyListEntry *
+  next() const
+  {
+    return next_;
+  }
+
+  /// Ready list the entry is queued on or was taken from, `nullptr` once released.
+  ReadyList *
+  queued_in() const
+  {
+    return queued_in_.load();
+  }
+
+  /// Ready list of the wait set the entity was last attached to, or `nullptr` if detached.
+  ReadyList *
+  owner() const
+  {
+    return owner_.load();
+  }
+
+  void
+  set_owner(ReadyList * owner)
+  {
+    owner_.store(owner);
+  }
+
+private:
+  friend class ReadyList;
+
+  std::atomic<ReadyList *> queued_in_;
+  ReadyListEntry * next_;
+  std::atomic<ReadyList *> owner_;
+};
+
+/// Lock-free list of the entities which became ready since a wait set last looked at them.
+/**
+ * Listeners push their entry from the Fast-RTPS threads, rmw_wait() takes all entries at once.
+ * An entry is in at most one list at a time: it stays queued in that list after being taken,
+ * until the consumer of that list releases it. When an entity moves to another wait set while
+ * its entry is still held by the previous one, pushes to the new list cannot queue the entry;
+ * they wake up its consumer instead, which then checks the entity directly.
+ *
+ * Where supported, the consumer can also block in park() until an entry is pushed, instead of
+ * waiting on a condition variable which every producer has to lock.
+ * Producers then only pay for an atomic load, plus a single syscall when the consumer is
+ * actually parked.
+ */
+class ReadyList
+{
+public:
+  ReadyList()
+  : head_(nullptr), poked_(false), parked_(0) {}
+
+  ReadyList(const ReadyList &) = delete;
+  ReadyList & operator=(const ReadyList &) = delete;
+
+  /// Queue an entry.
+  /**
+   * \return `false` if the entry was already queued or taken and not released yet.
+   */
+  bool
+  push(ReadyListEntry * entry)
+  {
+    if (!claim(entry)) {
+      if (entry->queued_in() != this) {
+        // Held by another list, which only releases it on its next take
+        poked_.store(true);
+        if (parked_.load() != 0) {
+          unpark();
+        }
+      }
+      return false;
+    }
+    ReadyListEntry * head = head_.load();
+    do {
+      entry->next_ = head;
+    } while (!head_.compare_exchange_weak(head, entry));
+    if (parked_.load() != 0) {
+      unpark();
+    }
+    return true;
+  }
+
+  /// Return `true` if no entry is queued and no push failed since the last take_all().
+  bool
+  empty() const
+  {
+    return head_.load() == nullptr && !poked_.load();
+  }
+
+  /// Take all queued entries, most recently pushed first.
+  ReadyListEntry *
+  take_all()
+  {
+    poked_.store(false);
+    return head_.exchange(nullptr);
+  }
+
+  /// Hold an entry which is in no list, as if it was pushed and taken.
+  /**
+   * \return `false` if the entry is held by a list already, possibly this one.
+   */
+  bool
+  claim(ReadyListEntry * entry)
+  {
+    ReadyList * holder = nullptr;
+    return entry->queued_in_.compare_exchange_strong(holder, this);
+  }
+
+  /// Allow a taken entry to be pushed again, does nothing if another list holds it.
+  void
+  release(ReadyListEntry * entry)
+  {
+    ReadyList * holder = this;
+    entry->queued_in_.compare_exchange_strong(holder, nullptr);
+  }
+
+  /// Return `true` if park() is supported on this platform.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  static bool
+  can_park();
+
+  /// Block until the list is not empty, or until the timeout expires.
+  /**
+   * Must only be called by one thread at a time, and only if can_park() returns `true`.
+   * May return early without the list being non empty, callers are expected to check again.
+   *
+   * \param timeout how long to wait for at most, or `nullptr` to wait without timeout
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  park(const std::chrono::nanoseconds * timeout);
+
+private:
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  unpark();
+
+  std::atomic<ReadyListEntry *> head_;
+  // Set when a push found its entry held by another list
+  std::atomic_bool poked_;
+  // 1 while a consumer is blocked in park(), used as futex word
+  std::atomic<uint32_t> parked_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__READY_LIST_HPP_
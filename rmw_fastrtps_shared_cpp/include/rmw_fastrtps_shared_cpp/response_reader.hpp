@@ -0,0 +1,157 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__RESPONSE_READER_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__RESPONSE_READER_HPP_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "fastcdr/FastBuffer.h"
+
+#include "fastrtps/attributes/SubscriberAttributes.h"
+#include "fastrtps/participant/Participant.h"
+#include "fastrtps/rtps/common/Guid.h"
+#include "fastrtps/subscriber/Subscriber.h"
+#include "fastrtps/subscriber/SubscriberListener.h"
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw/types.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/visibility_control.h"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Reader of the responses of a service, shared by the clients of a participant.
+/**
+ * Every client of a service subscribes to the same response topic, so every response reaches
+ * every client. Responses are instead received once per participant, and routed to the client
+ * which wrote the request by the writer GUID of the request they relate to.
+ * Responses to the requests of other participants are dropped when they are taken, without
+ * copying them when possible.
+ */
+class ResponseReader : public eprosima::fastrtps::SubscriberListener
+{
+public:
+  ResponseReader()
+  : subscriber_(nullptr)
+  {}
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  onNewDataMessage(eprosima::fastrtps::Subscriber * sub) final;
+
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  onSubscriptionMatched(
+    eprosima::fastrtps::Subscriber * sub,
+    eprosima::fastrtps::rtps::MatchingInfo & info) final;
+
+  /// Route the responses to the requests of a request writer to a client.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  addClient(const eprosima::fastrtps::rtps::GUID_t & writer_guid, ClientListener * listener);
+
+  /// Stop routing responses to a client, which must be done before it is destroyed.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  removeClient(const eprosima::fastrtps::rtps::GUID_t & writer_guid);
+
+  /// Give back the buffer of a response once it has been deserialized.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  returnBuffer(std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer);
+
+  eprosima::fastrtps::Subscriber *
+  subscriber() const
+  {
+    return subscriber_;
+  }
+
+private:
+  friend class ResponseReaders;
+
+  /// Return whether the next response to take is expected by a client of the reader.
+  /**
+   * Checked before taking the response, so that responses to the requests of other
+   * participants, or to requests which are not in flight anymore, are not copied.
+   * Without a way to get the sample info of a response before taking it, as with Fast-RTPS
+   * older than 1.10, responses are assumed to be routed.
+   */
+  bool
+  isNextResponseRouted(eprosima::fastrtps::Subscriber * sub);
+
+  // Buffers are recycled, and keep the storage they grew to for the next responses
+  std::unique_ptr<eprosima::fastcdr::FastBuffer>
+  acquireBuffer();
+
+  eprosima::fastrtps::Subscriber * subscriber_;
+  std::mutex mutex_;
+  std::map<eprosima::fastrtps::rtps::GUID_t, ClientListener *> clients_
+  RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<eprosima::fastcdr::FastBuffer>> buffers_
+  RCPPUTILS_TSA_GUARDED_BY(mutex_);
+  std::set<eprosima::fastrtps::rtps::GUID_t> publishers_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+/// Response readers of the clients of a participant.
+class ResponseReaders
+{
+public:
+  /// Return the reader of a response topic, creating it for the first client which uses it.
+  /**
+   * A reader is only shared by clients with the same response type and QoS.
+   *
+   * \param participant the reader is created in
+   * \param attributes of the reader, with the response topic and QoS set
+   * \param qos the attributes were created from
+   * \return the reader, or nullptr if it could not be created
+   */
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  std::shared_ptr<ResponseReader>
+  acquire(
+    eprosima::fastrtps::Participant * participant,
+    const eprosima::fastrtps::SubscriberAttributes & attributes,
+    const rmw_qos_profile_t & qos);
+
+  /// Drop a reference to a reader, and remove its subscriber with the last one.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void
+  release(const std::shared_ptr<ResponseReader> & reader);
+
+private:
+  struct Entry
+  {
+    std::string type_name;
+    rmw_qos_profile_t qos;
+    std::shared_ptr<ResponseReader> reader;
+    // Number of clients using reader
+    size_t ref_count;
+  };
+
+  std::mutex mutex_;
+  // Readers by response topic name
+  std::multimap<std::string, Entry> readers_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__RESPONSE_READER_HPP_
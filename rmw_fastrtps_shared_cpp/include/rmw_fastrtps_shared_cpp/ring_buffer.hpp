@@ -0,0 +1,95 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__RING_BUFFER_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__RING_BUFFER_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// First in, first out queue stored in a circular buffer.
+/**
+ * Unlike std::list or std::deque, it does not allocate on every push or every few pushes: its
+ * storage only grows, doubling, when it is full.
+ */
+template<typename T>
+class RingBuffer
+{
+public:
+  RingBuffer()
+  : head_(0), size_(0)
+  {}
+
+  bool
+  empty() const
+  {
+    return size_ == 0;
+  }
+
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  void
+  push_back(T && value)
+  {
+    if (size_ == storage_.size()) {
+      grow(storage_.empty() ? 4u : 2u * storage_.size());
+    }
+    storage_[(head_ + size_) % storage_.size()] = std::move(value);
+    ++size_;
+  }
+
+  T &
+  front()
+  {
+    assert(!empty());
+    return storage_[head_];
+  }
+
+  void
+  pop_front()
+  {
+    assert(!empty());
+    head_ = (head_ + 1) % storage_.size();
+    --size_;
+  }
+
+private:
+  void
+  grow(size_t capacity)
+  {
+    std::vector<T> storage(capacity);
+    for (size_t i = 0; i < size_; ++i) {
+      storage[i] = std::move(storage_[(head_ + i) % storage_.size()]);
+    }
+    storage_.swap(storage);
+    head_ = 0;
+  }
+
+  std::vector<T> storage_;
+  size_t head_;
+  size_t size_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__RING_BUFFER_HPP_
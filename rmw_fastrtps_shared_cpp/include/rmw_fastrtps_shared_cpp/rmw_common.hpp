@@ -87,6 +87,7 @@ RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_node_t *
 __rmw_create_node(
   const char * identifier,
+  rmw_context_t * context,
   const char * name,
   const char * namespace_,
   size_t domain_id,
@@ -117,6 +118,19 @@ __rmw_get_node_names(
   rcutils_string_array_t * node_names,
   rcutils_string_array_t * node_namespaces);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_init_publisher_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_publisher_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_fini_publisher_allocation(
+  const char * identifier,
+  rmw_publisher_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_publish(
@@ -158,6 +172,28 @@ __rmw_publisher_get_actual_qos(
   const rmw_publisher_t * publisher,
   rmw_qos_profile_t * qos);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void ** ros_message);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_request(
@@ -166,6 +202,19 @@ __rmw_send_request(
   const void * ros_request,
   int64_t * sequence_id);
 
+/// Send a request which times out if its response does not arrive in time.
+/**
+ * A zero timeout never expires, as with __rmw_send_request.
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_send_request_with_timeout(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_time_t timeout,
+  int64_t * sequence_id);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_request(
@@ -184,6 +233,22 @@ __rmw_take_response(
   void * ros_response,
   bool * taken);
 
+/// Take the response to a specific request of a client.
+/**
+ * \return RMW_RET_OK if the response was taken or has not arrived yet, see taken
+ * \return RMW_RET_TIMEOUT if the request timed out, it is not in flight anymore after that
+ * \return RMW_RET_INVALID_ARGUMENT if the request is not in flight
+ */
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_response_for_request(
+  const char * identifier,
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_send_response(
@@ -257,6 +322,19 @@ __rmw_service_server_is_available(
   const rmw_client_t * client,
   bool * is_available);
 
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_init_subscription_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_subscription_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_fini_subscription_allocation(
+  const char * identifier,
+  rmw_subscription_allocation_t * allocation);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_destroy_subscription(
@@ -303,6 +381,45 @@ __rmw_take_with_info(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation);
 
+// Take up to count messages into the ros_messages array, and their info into the
+// message_infos array if not null. The number of messages taken is stored in taken.
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_sequence(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_loaned_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_take_loaned_message_with_info(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation);
+
+RMW_FASTRTPS_SHARED_CPP_PUBLIC
+rmw_ret_t
+__rmw_return_loaned_message_from_subscription(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * loaned_message);
+
 RMW_FASTRTPS_SHARED_CPP_PUBLIC
 rmw_ret_t
 __rmw_take_serialized_message(
@@ -0,0 +1,67 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "fastrtps/participant/Participant.h"
+#include "fastrtps/TopicDataType.h"
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw/init.h"
+
+class GraphCache;
+class ParticipantListener;
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+class ResponseReaders;
+
+/// Participant shared by the nodes of a context which were created with the same options.
+struct ContextParticipant
+{
+  size_t domain_id;
+  bool localhost_only;
+  std::string security_root_path;
+  bool enforce_security;
+
+  eprosima::fastrtps::Participant * participant;
+  ::ParticipantListener * listener;
+  // Type of the node announcement publishers of the nodes, registered on participant
+  eprosima::fastrtps::TopicDataType * node_announcement_type;
+  std::shared_ptr<GraphCache> graph_cache;
+  std::shared_ptr<ResponseReaders> response_readers;
+  // Number of nodes using participant
+  size_t node_count;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+struct rmw_context_impl_t
+{
+  std::mutex mutex;
+  // Participants of the nodes of this context. There is a single one, unless nodes are created
+  // with different domain ids, localhost only or security options.
+  std::vector<std::unique_ptr<rmw_fastrtps_shared_cpp::ContextParticipant>> participants
+  RCPPUTILS_TSA_GUARDED_BY(mutex);
+};
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__RMW_CONTEXT_IMPL_HPP_
@@ -0,0 +1,124 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RMW_FASTRTPS_SHARED_CPP__SHARED_MUTEX_HPP_
+#define RMW_FASTRTPS_SHARED_CPP__SHARED_MUTEX_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Readers-writer lock which prefers writers.
+/**
+ * std::shared_timed_mutex gives no guarantee about who goes first, and common implementations
+ * let new readers in as long as one holds the lock, so a steady flow of readers can starve a
+ * writer.
+ * Here, once a writer waits, new readers wait behind it: a writer only waits for the readers
+ * already holding the lock.
+ *
+ * It meets the SharedMutex requirements, so it is used with std::lock_guard, std::unique_lock
+ * and std::shared_lock.
+ */
+class RCPPUTILS_TSA_CAPABILITY("mutex") SharedMutex
+{
+public:
+  SharedMutex()
+  : readers_(0), writers_waiting_(0), writer_(false)
+  {}
+
+  SharedMutex(const SharedMutex &) = delete;
+  SharedMutex & operator=(const SharedMutex &) = delete;
+
+  void
+  lock() RCPPUTILS_TSA_ACQUIRE()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++writers_waiting_;
+    writer_cv_.wait(lock, [this] {return !writer_ && readers_ == 0;});
+    --writers_waiting_;
+    writer_ = true;
+  }
+
+  bool
+  try_lock() RCPPUTILS_TSA_TRY_ACQUIRE(true)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writer_ || readers_ > 0) {
+      return false;
+    }
+    writer_ = true;
+    return true;
+  }
+
+  void
+  unlock() RCPPUTILS_TSA_RELEASE()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      writer_ = false;
+    }
+    // Another writer goes first if there is one, readers are woken up in case there is none
+    writer_cv_.notify_one();
+    readers_cv_.notify_all();
+  }
+
+  void
+  lock_shared() RCPPUTILS_TSA_ACQUIRE_SHARED()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    readers_cv_.wait(lock, [this] {return !writer_ && writers_waiting_ == 0;});
+    ++readers_;
+  }
+
+  bool
+  try_lock_shared() RCPPUTILS_TSA_TRY_ACQUIRE_SHARED(true)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writer_ || writers_waiting_ > 0) {
+      return false;
+    }
+    ++readers_;
+    return true;
+  }
+
+  void
+  unlock_shared() RCPPUTILS_TSA_RELEASE_SHARED()
+  {
+    bool last_reader;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last_reader = --readers_ == 0;
+    }
+    if (last_reader) {
+      writer_cv_.notify_one();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable readers_cv_;
+  std::condition_variable writer_cv_;
+  size_t readers_;
+  size_t writers_waiting_;
+  bool writer_;
+};
+
+}  // namespace rmw_fastrtps_shared_cpp
+
+#endif  // RMW_FASTRTPS_SHARED_CPP__SHARED_MUTEX_HPP_
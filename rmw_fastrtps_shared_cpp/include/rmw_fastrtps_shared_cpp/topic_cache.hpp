@@ -16,9 +16,12 @@
 #define RMW_FASTRTPS_SHARED_CPP__TOPIC_CACHE_HPP_
 
 #include <algorithm>
+#include <cassert>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -31,9 +34,30 @@
 #include "rcpputils/thread_safety_annotations.hpp"
 #include "rcutils/logging_macros.h"
 
+#include "interned_string.hpp"
 #include "qos.hpp"
+#include "shared_mutex.hpp"
+#include "visibility_control.h"
 
 typedef eprosima::fastrtps::rtps::GUID_t GUID_t;
+typedef rmw_fastrtps_shared_cpp::InternedString InternedString;
+
+/// Hash of a GUID, to key unordered containers by GUID.
+struct GUIDHash
+{
+  size_t operator()(const GUID_t & guid) const
+  {
+    // FNV-1a over the GUID prefix and entity id
+    size_t hash = 14695981039346656037ULL;
+    for (auto octet : guid.guidPrefix.value) {
+      hash = (hash ^ octet) * 1099511628211ULL;
+    }
+    for (auto octet : guid.entityId.value) {
+      hash = (hash ^ octet) * 1099511628211ULL;
+    }
+    return hash;
+  }
+};
 
 /**
  * A data structure that encapsulates all the data associated with a publisher
@@ -43,19 +67,67 @@ struct TopicData
 {
   GUID_t participant_guid;
   GUID_t entity_guid;
-  std::string topic_type;
+  InternedString topic_type;
   rmw_qos_profile_t qos_profile;
 };
 
+/// Names a topic is listed under by graph queries, demangled once when the topic is added.
+struct DemangledTopic
+{
+  // Whether the topic is the one of a ROS publisher or subscription, rather than of a service
+  bool is_ros_topic;
+  // Name without the ROS prefix, or the topic name if it has none
+  std::string topic_name;
+  // Name of the service the topic is the request or reply topic of, or empty
+  std::string service_name;
+};
+
+/// Names a type is listed under by graph queries, demangled once when the type is added.
+struct DemangledType
+{
+  // Name in the ROS format, or the type name if it is not a ROS type
+  std::string type_name;
+  // Name of the service type in the ROS format, only set for types of service topics
+  std::string service_type_name;
+};
+
 /**
  * Topic cache data structure. Manages relationships between participants and topics.
  */
 class TopicCache
 {
 private:
-  using TopicToTypes = std::unordered_map<std::string, std::vector<std::string>>;
+  // Topic names and types are interned, as every publisher or subscription of a topic lists the
+  // same few, so that keys are hashed and compared by pointer
+  using TopicToTypes = std::unordered_map<InternedString, std::vector<InternedString>>;
   using ParticipantTopicMap = std::map<GUID_t, TopicToTypes>;
-  using TopicNameToTopicData = std::unordered_map<std::string, std::vector<TopicData>>;
+  using TopicNameToTopicData = std::unordered_map<InternedString, std::vector<TopicData>>;
+  using TopicToEntities = std::unordered_map<InternedString, std::vector<GUID_t>>;
+  // Publisher or subscription GUID and topic name
+  using EntityKey = std::pair<GUID_t, InternedString>;
+
+  struct EntityKeyHash
+  {
+    size_t operator()(const EntityKey & key) const
+    {
+      size_t hash = GUIDHash()(key.first);
+      size_t topic_hash = std::hash<InternedString>()(key.second);
+      return hash ^ (topic_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+    }
+  };
+
+  /**
+   * Position of a publisher or subscription in the vectors of the maps below, so that it is
+   * removed by swapping it with the last element instead of searching for it.
+   */
+  struct EntityPosition
+  {
+    GUID_t participant_guid;
+    // Index in topic_name_to_topic_data_[topic_name] and topic_to_types_[topic_name]
+    size_t topic_index;
+    // Index in participant_to_topics_[participant_guid][topic_name]
+    size_t participant_index;
+  };
 
   /**
    * Map of topic names to TopicData. Where topic data is vector of tuples containing
@@ -67,11 +139,44 @@ private:
    */
   TopicNameToTopicData topic_name_to_topic_data_;
 
+  /**
+   * Map of topic names to the types of their publishers or subscriptions, one per entity.
+   * Kept along topic_name_to_topic_data_, so that looking up a topic does not rebuild it.
+   */
+  TopicToTypes topic_to_types_;
+
   /**
    * Map of participant GUIDS to a set of topic-type.
    */
   ParticipantTopicMap participant_to_topics_;
 
+  /**
+   * Map of participant GUIDs to the GUIDs of their publishers or subscriptions by topic, in the
+   * same order as their types in participant_to_topics_.
+   */
+  std::map<GUID_t, TopicToEntities> participant_to_entities_;
+
+  /**
+   * Demangled names of the topics in topic_name_to_topic_data_, and of the types of their
+   * publishers or subscriptions, so that graph queries do not demangle them every time.
+   */
+  std::unordered_map<InternedString, DemangledTopic> demangled_topics_;
+  struct DemangledTypeEntry
+  {
+    DemangledType names;
+    // Whether names.service_type_name was set, once the type was added on a service topic
+    bool has_service_type_name;
+    // Number of publishers or subscriptions of the type
+    size_t ref_count;
+  };
+  std::unordered_map<InternedString, DemangledTypeEntry> demangled_types_;
+
+  /// Demangle the names of a topic and type, unless they are known already.
+  RMW_FASTRTPS_SHARED_CPP_PUBLIC
+  void addDemangledNames(const InternedString & topic_name, const InternedString & type_name);
+
+  std::unordered_map<EntityKey, EntityPosition, EntityKeyHash> entity_positions_;
+
   /**
    * Helper function to initialize an empty TopicData for a topic name.
    *
@@ -79,7 +184,7 @@ private:
    * \param topic_name_to_topic_data the map to initialize.
    */
   void initializeTopicDataMap(
-    const std::string & topic_name,
+    const InternedString & topic_name,
     TopicNameToTopicData & topic_name_to_topic_data)
   {
     if (topic_name_to_topic_data.find(topic_name) == topic_name_to_topic_data.end()) {
@@ -93,10 +198,10 @@ private:
     * \param topic_name the topic name for which the TopicToTypes map should be initialized.
     * \param topic_to_types the map to initialize.
     */
-  void initializeTopicTypesMap(const std::string & topic_name, TopicToTypes & topic_to_types)
+  void initializeTopicTypesMap(const InternedString & topic_name, TopicToTypes & topic_to_types)
   {
     if (topic_to_types.find(topic_name) == topic_to_types.end()) {
-      topic_to_types[topic_name] = std::vector<std::string>();
+      topic_to_types[topic_name] = std::vector<InternedString>();
     }
   }
 
@@ -119,16 +224,9 @@ public:
   /**
    * \return a map of topic name to the vector of topic types used.
    */
-  const TopicToTypes getTopicToTypes() const
+  const TopicToTypes & getTopicToTypes() const
   {
-    TopicToTypes topic_to_types;
-    for (const auto & it : topic_name_to_topic_data_) {
-      topic_to_types[it.first] = std::vector<std::string>();
-      for (const auto & topic_data : it.second) {
-        topic_to_types[it.first].push_back(topic_data.topic_type);
-      }
-    }
-    return topic_to_types;
+    return topic_to_types_;
   }
 
   /**
@@ -139,6 +237,26 @@ public:
     return participant_to_topics_;
   }
 
+  /**
+   * \return the demangled names of a topic of the cache
+   */
+  const DemangledTopic & getDemangledTopic(const InternedString & topic_name) const
+  {
+    auto it = demangled_topics_.find(topic_name);
+    assert(it != demangled_topics_.end());
+    return it->second;
+  }
+
+  /**
+   * \return the demangled names of the type of a publisher or subscription of the cache
+   */
+  const DemangledType & getDemangledType(const InternedString & type_name) const
+  {
+    auto it = demangled_types_.find(type_name);
+    assert(it != demangled_types_.end());
+    return it->second.names;
+  }
+
   /**
    * \return a map of topic name to a vector of GUID_t, type name and qos profile tuple.
    */
@@ -161,14 +279,43 @@ public:
   bool addTopic(
     const eprosima::fastrtps::rtps::InstanceHandle_t & rtpsParticipantKey,
     const GUID_t & entity_guid,
-    const std::string & topic_name,
-    const std::string & type_name,
+    const InternedString & topic_name,
+    const InternedString & type_name,
     const T & dds_qos)
   {
+    return addTopic(iHandle2GUID(rtpsParticipantKey), entity_guid, topic_name, type_name, dds_qos);
+  }
+
+  /**
+   * Add a topic based on discovery.
+   *
+   * \param participant_guid the guid of the node or participant owning the publisher or
+   *   subscription
+   * \param entity_guid the guid of the publisher or subscription
+   * \param topic_name the topic name associated with the discovered publisher or subscription
+   * \param type_name the topic type associated with the discovered publisher or subscription
+   * \param dds_qos the dds qos policy of the discovered publisher or subscription
+   * \return true if a change has been recorded
+   */
+  template<class T>
+  bool addTopic(
+    const GUID_t & participant_guid,
+    const GUID_t & entity_guid,
+    const InternedString & topic_name,
+    const InternedString & type_name,
+    const T & dds_qos)
+  {
+    EntityKey key(entity_guid, topic_name);
+    if (entity_positions_.find(key) != entity_positions_.end()) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "topic '%s' with type '%s' added twice for the same entity",
+        topic_name.c_str(), type_name.c_str());
+      return false;
+    }
     initializeTopicDataMap(topic_name, topic_name_to_topic_data_);
-    auto participant_guid = iHandle2GUID(rtpsParticipantKey);
     initializeParticipantMap(participant_to_topics_, participant_guid);
-    initializeTopicTypesMap(topic_name, participant_to_topics_[entity_guid]);
+    initializeTopicTypesMap(topic_name, participant_to_topics_[participant_guid]);
     if (rcutils_logging_logger_is_enabled_for("rmw_fastrtps_shared_cpp",
       RCUTILS_LOG_SEVERITY_DEBUG))
     {
@@ -187,8 +334,16 @@ public:
       type_name,
       qos_profile
     };
-    topic_name_to_topic_data_[topic_name].push_back(topic_data);
-    participant_to_topics_[participant_guid][topic_name].push_back(type_name);
+    auto & topic_data_vec = topic_name_to_topic_data_[topic_name];
+    auto & participant_types = participant_to_topics_[participant_guid][topic_name];
+    entity_positions_.emplace(
+      std::move(key),
+      EntityPosition {participant_guid, topic_data_vec.size(), participant_types.size()});
+    topic_data_vec.push_back(topic_data);
+    topic_to_types_[topic_name].push_back(type_name);
+    participant_types.push_back(type_name);
+    participant_to_entities_[participant_guid][topic_name].push_back(entity_guid);
+    addDemangledNames(topic_name, type_name);
     return true;
   }
 
@@ -204,45 +359,88 @@ public:
   bool removeTopic(
     const eprosima::fastrtps::rtps::InstanceHandle_t & rtpsParticipantKey,
     const eprosima::fastrtps::rtps::GUID_t & entity_guid,
-    const std::string & topic_name,
-    const std::string & type_name)
+    const InternedString & topic_name,
+    const InternedString & type_name)
+  {
+    return removeTopic(iHandle2GUID(rtpsParticipantKey), entity_guid, topic_name, type_name);
+  }
+
+  /**
+   * Remove a topic based on discovery.
+   *
+   * \param participant_guid the guid of the node or participant owning the publisher or
+   *   subscription
+   * \param entity_guid the guid of the publisher or subscription
+   * \param topic_name the topic name associated with the publisher or subscription
+   * \param type_name the topic type associated with the publisher or subscription
+   * \return true if a change has been recorded
+   */
+  bool removeTopic(
+    const GUID_t & participant_guid,
+    const eprosima::fastrtps::rtps::GUID_t & entity_guid,
+    const InternedString & topic_name,
+    const InternedString & type_name)
   {
-    if (topic_name_to_topic_data_.find(topic_name) == topic_name_to_topic_data_.end()) {
+    auto position = entity_positions_.find(EntityKey(entity_guid, topic_name));
+    if (
+      position == entity_positions_.end() ||
+      topic_name_to_topic_data_[topic_name][position->second.topic_index].topic_type !=
+      type_name)
+    {
       RCUTILS_LOG_DEBUG_NAMED(
         "rmw_fastrtps_shared_cpp",
         "unexpected removal on topic '%s' with type '%s'",
         topic_name.c_str(), type_name.c_str());
       return false;
     }
+    EntityPosition removed = position->second;
+    entity_positions_.erase(position);
+    auto demangled_type = demangled_types_.find(type_name);
+    if (--demangled_type->second.ref_count == 0) {
+      demangled_types_.erase(demangled_type);
+    }
+    // The entity is listed under the participant it was added for
+    assert(removed.participant_guid == participant_guid);
+    (void)participant_guid;
+
     {
-      auto & type_vec = topic_name_to_topic_data_[topic_name];
-      type_vec.erase(std::find_if(type_vec.begin(), type_vec.end(),
-        [type_name, entity_guid](const auto & topic_data) {
-          return type_name.compare(topic_data.topic_type) == 0 &&
-          entity_guid == topic_data.entity_guid;
-        }));
-      if (type_vec.empty()) {
+      auto & topic_data_vec = topic_name_to_topic_data_[topic_name];
+      auto & type_vec = topic_to_types_[topic_name];
+      if (removed.topic_index + 1 != topic_data_vec.size()) {
+        topic_data_vec[removed.topic_index] = std::move(topic_data_vec.back());
+        type_vec[removed.topic_index] = std::move(type_vec.back());
+        entity_positions_[EntityKey(topic_data_vec[removed.topic_index].entity_guid, topic_name)]
+        .topic_index = removed.topic_index;
+      }
+      topic_data_vec.pop_back();
+      type_vec.pop_back();
+      if (topic_data_vec.empty()) {
         topic_name_to_topic_data_.erase(topic_name);
+        topic_to_types_.erase(topic_name);
+        demangled_topics_.erase(topic_name);
       }
     }
-    auto participant_guid = iHandle2GUID(rtpsParticipantKey);
-    auto guid_topics_pair = participant_to_topics_.find(participant_guid);
-    if (guid_topics_pair != participant_to_topics_.end() &&
-      guid_topics_pair->second.find(topic_name) != guid_topics_pair->second.end())
     {
-      auto & type_vec = guid_topics_pair->second[topic_name];
-      type_vec.erase(std::find(type_vec.begin(), type_vec.end(), type_name));
+      auto & topics = participant_to_topics_[removed.participant_guid];
+      auto & entities = participant_to_entities_[removed.participant_guid];
+      auto & type_vec = topics[topic_name];
+      auto & entity_vec = entities[topic_name];
+      if (removed.participant_index + 1 != type_vec.size()) {
+        type_vec[removed.participant_index] = std::move(type_vec.back());
+        entity_vec[removed.participant_index] = entity_vec.back();
+        entity_positions_[EntityKey(entity_vec[removed.participant_index], topic_name)]
+        .participant_index = removed.participant_index;
+      }
+      type_vec.pop_back();
+      entity_vec.pop_back();
       if (type_vec.empty()) {
-        participant_to_topics_[participant_guid].erase(topic_name);
+        topics.erase(topic_name);
+        entities.erase(topic_name);
       }
-      if (participant_to_topics_[participant_guid].empty()) {
-        participant_to_topics_.erase(participant_guid);
+      if (topics.empty()) {
+        participant_to_topics_.erase(removed.participant_guid);
+        participant_to_entities_.erase(removed.participant_guid);
       }
-    } else {
-      RCUTILS_LOG_ERROR_NAMED(
-        "rmw_fastrtps_shared_cpp",
-        "Unable to remove topic, does not exist '%s' with type '%s'",
-        topic_name.c_str(), type_name.c_str());
     }
     return true;
   }
@@ -260,7 +458,7 @@ inline std::ostream & operator<<(
     for (auto & types : elem.second) {
       stream << "    " << types.first << ": ";
       std::copy(types.second.begin(), types.second.end(),
-        std::ostream_iterator<std::string>(stream, ","));
+        std::ostream_iterator<InternedString>(stream, ","));
       stream << std::endl;
     }
     map_ss << elem.first << std::endl << stream.str();
@@ -269,7 +467,7 @@ inline std::ostream & operator<<(
   topics_ss << "Cumulative TopicToTypes: " << std::endl;
   for (auto & elem : topic_cache.getTopicToTypes()) {
     std::ostringstream stream;
-    std::copy(elem.second.begin(), elem.second.end(), std::ostream_iterator<std::string>(stream,
+    std::copy(elem.second.begin(), elem.second.end(), std::ostream_iterator<InternedString>(stream,
       ","));
     topics_ss << "  " << elem.first << " : " << stream.str() << std::endl;
   }
@@ -277,18 +475,25 @@ inline std::ostream & operator<<(
   return ostream;
 }
 
+/**
+ * Object guarded by a readers-writer lock.
+ *
+ * Queries lock it shared, so that they run concurrently with each other, and updates lock it
+ * exclusively. The lock prefers writers, so that a steady flow of queries cannot hold off the
+ * updates.
+ */
 template<class T>
 class LockedObject
 {
 private:
-  mutable std::mutex mutex_;
+  mutable rmw_fastrtps_shared_cpp::SharedMutex mutex_;
   T object_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
 
 public:
   /**
   * \return a reference to this object to lock.
   */
-  std::mutex & getMutex() const RCPPUTILS_TSA_RETURN_CAPABILITY(mutex_)
+  rmw_fastrtps_shared_cpp::SharedMutex & getMutex() const RCPPUTILS_TSA_RETURN_CAPABILITY(mutex_)
   {
     return mutex_;
   }
@@ -83,10 +83,23 @@ bool TypeSupport::deserialize(
   auto ser_data = static_cast<SerializedData *>(data);
   if (ser_data->is_cdr_buffer) {
     auto buffer = static_cast<eprosima::fastcdr::FastBuffer *>(ser_data->data);
-    if (!buffer->reserve(payload->length)) {
+    if (!buffer) {
+      // The sample is discarded, there is nothing to copy
+      ser_data->length = 0;
+      return true;
+    }
+    if (buffer->getBuffer()) {
+      // Only buffers owning their storage can grow
+      if (buffer->getBufferSize() < payload->length &&
+        !buffer->resize(payload->length - buffer->getBufferSize()))
+      {
+        return false;
+      }
+    } else if (!buffer->reserve(payload->length)) {
       return false;
     }
     memcpy(buffer->getBuffer(), payload->data, payload->length);
+    ser_data->length = payload->length;
     return true;
   }
 
@@ -37,6 +37,9 @@ SubListener::on_requested_deadline_missed(
   requested_deadline_missed_status_.total_count_change += status.total_count_change;
 
   deadline_changes_.store(true, std::memory_order_relaxed);
+  if (readyList_ != nullptr) {
+    readyList_->push(&readyListEntry_);
+  }
 }
 
 void SubListener::on_liveliness_changed(
@@ -57,6 +60,9 @@ void SubListener::on_liveliness_changed(
   liveliness_changed_status_.not_alive_count_change += status.not_alive_count_change;
 
   liveliness_changes_.store(true, std::memory_order_relaxed);
+  if (readyList_ != nullptr) {
+    readyList_->push(&readyListEntry_);
+  }
 }
 
 bool SubListener::hasEvent(rmw_event_type_t event_type) const
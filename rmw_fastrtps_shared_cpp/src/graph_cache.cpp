@@ -0,0 +1,37 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "rmw_fastrtps_shared_cpp/graph_cache.hpp"
+
+std::shared_ptr<GraphCache>
+GraphCache::get_for_domain(size_t domain_id, bool localhost_only)
+{
+  static std::mutex mutex;
+  // Graph caches are destroyed along with the last participant using them
+  static std::map<std::pair<size_t, bool>, std::weak_ptr<GraphCache>> graph_caches;
+
+  std::lock_guard<std::mutex> guard(mutex);
+  auto & weak_graph_cache = graph_caches[std::make_pair(domain_id, localhost_only)];
+  std::shared_ptr<GraphCache> graph_cache = weak_graph_cache.lock();
+  if (!graph_cache) {
+    graph_cache = std::make_shared<GraphCache>();
+    weak_graph_cache = graph_cache;
+  }
+  return graph_cache;
+}
@@ -0,0 +1,150 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw_fastrtps_shared_cpp/interned_string.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+namespace
+{
+// Characters of a string, looked up without copying them into a std::string
+struct StringKey
+{
+  const char * data;
+  size_t size;
+};
+
+struct StringKeyHash
+{
+  size_t operator()(const StringKey & key) const
+  {
+    // FNV-1a
+    size_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < key.size; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(key.data[i])) * 1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
+struct StringKeyEqual
+{
+  bool operator()(const StringKey & a, const StringKey & b) const
+  {
+    return a.size == b.size && memcmp(a.data, b.data, a.size) == 0;
+  }
+};
+
+class StringTable
+{
+public:
+  std::shared_ptr<const std::string>
+  intern(const char * data, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = strings_.find(StringKey {data, size});
+    if (it != strings_.end()) {
+      std::shared_ptr<const std::string> string = it->second.lock();
+      if (string) {
+        return string;
+      }
+      // Its last copy is being released, replace it
+      strings_.erase(it);
+    }
+    std::shared_ptr<const std::string> string(new std::string(data, size), Release {this});
+    // The key points to the characters of the string, which do not move until it is freed
+    strings_.emplace(StringKey {string->data(), string->size()}, string);
+    return string;
+  }
+
+  std::shared_ptr<const std::string>
+  find(const std::string & str)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = strings_.find(StringKey {str.data(), str.size()});
+    return it == strings_.end() ? nullptr : it->second.lock();
+  }
+
+private:
+  struct Release
+  {
+    StringTable * table;
+
+    void operator()(const std::string * string) const
+    {
+      {
+        std::lock_guard<std::mutex> lock(table->mutex_);
+        auto it = table->strings_.find(StringKey {string->data(), string->size()});
+        // Unless the string was interned again since its last copy went away
+        if (it != table->strings_.end() && it->first.data == string->data()) {
+          table->strings_.erase(it);
+        }
+      }
+      delete string;
+    }
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<StringKey, std::weak_ptr<const std::string>, StringKeyHash, StringKeyEqual>
+  strings_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+StringTable &
+_string_table()
+{
+  // Never destroyed, as interned strings can be released after static destruction
+  static StringTable * table = new StringTable();
+  return *table;
+}
+}  // namespace
+
+InternedString::InternedString(const char * data, size_t size)
+{
+  if (size > 0) {
+    string_ = _string_table().intern(data, size);
+  }
+}
+
+bool
+InternedString::find(const std::string & str, InternedString & interned)
+{
+  if (str.empty()) {
+    interned = InternedString();
+    return true;
+  }
+  std::shared_ptr<const std::string> string = _string_table().find(str);
+  if (!string) {
+    return false;
+  }
+  interned.string_ = std::move(string);
+  return true;
+}
+
+const std::string &
+InternedString::empty_string()
+{
+  static const std::string * empty = new std::string();
+  return *empty;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
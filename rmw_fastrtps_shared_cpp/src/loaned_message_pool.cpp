@@ -0,0 +1,112 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+LoanedMessagePool::LoanedMessagePool(
+  size_t message_size,
+  size_t preallocated_count,
+  MessageFunction init_function,
+  MessageFunction fini_function)
+: message_size_(message_size),
+  init_function_(std::move(init_function)),
+  fini_function_(std::move(fini_function))
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  available_.reserve(preallocated_count);
+  for (size_t i = 0; i < preallocated_count; ++i) {
+    void * message = allocate();
+    if (!message) {
+      break;
+    }
+    available_.push_back(message);
+  }
+}
+
+LoanedMessagePool::~LoanedMessagePool()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & entry : messages_) {
+    fini_function_(entry.first);
+    ::operator delete(entry.first);
+  }
+}
+
+void *
+LoanedMessagePool::borrow()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  void * message = nullptr;
+  if (available_.empty()) {
+    message = allocate();
+    if (!message) {
+      return nullptr;
+    }
+  } else {
+    message = available_.back();
+    available_.pop_back();
+  }
+  messages_[message] = true;
+  return message;
+}
+
+bool
+LoanedMessagePool::is_loaned(void * message)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = messages_.find(message);
+  return it != messages_.end() && it->second;
+}
+
+bool
+LoanedMessagePool::give_back(void * message)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = messages_.find(message);
+  if (it == messages_.end() || !it->second) {
+    return false;
+  }
+  it->second = false;
+  available_.push_back(message);
+  return true;
+}
+
+void *
+LoanedMessagePool::allocate()
+{
+  void * message = ::operator new(message_size_, std::nothrow);
+  if (!message) {
+    return nullptr;
+  }
+  try {
+    messages_.emplace(message, false);
+    // Make sure giving all messages back never needs to allocate
+    available_.reserve(messages_.size());
+  } catch (std::bad_alloc &) {
+    messages_.erase(message);
+    ::operator delete(message);
+    return nullptr;
+  }
+  init_function_(message);
+  return message;
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
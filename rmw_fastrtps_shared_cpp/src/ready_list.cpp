@@ -0,0 +1,91 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+#ifdef __linux__
+static_assert(
+  sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && ATOMIC_INT_LOCK_FREE == 2,
+  "std::atomic<uint32_t> cannot be used as a futex word");
+
+namespace
+{
+int64_t
+futex(std::atomic<uint32_t> * word, int op, uint32_t val, const struct timespec * timeout)
+{
+  return syscall(
+    SYS_futex, reinterpret_cast<uint32_t *>(word), op, val, timeout, nullptr, 0);
+}
+}  // namespace
+#endif
+
+bool
+ReadyList::can_park()
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+ReadyList::park(const std::chrono::nanoseconds * timeout)
+{
+#ifdef __linux__
+  struct timespec ts;
+  if (timeout) {
+    auto ns = timeout->count() > 0 ? timeout->count() : 0;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+    ts.tv_nsec = static_cast<decltype(ts.tv_nsec)>(ns % 1000000000);
+  }
+  // A producer pushing after this store sees parked_ set and wakes us up, a producer which
+  // pushed before it is seen by the check below
+  parked_.store(1);
+  if (empty()) {
+    // Returns immediately if a producer already reset parked_
+    futex(&parked_, FUTEX_WAIT_PRIVATE, 1, timeout ? &ts : nullptr);
+  }
+  parked_.store(0);
+#else
+  (void)timeout;
+#endif
+}
+
+void
+ReadyList::unpark()
+{
+#ifdef __linux__
+  // Only the first producer seeing the consumer parked makes the syscall
+  if (parked_.exchange(0) != 0) {
+    futex(&parked_, FUTEX_WAKE_PRIVATE, 1, nullptr);
+  }
+#endif
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
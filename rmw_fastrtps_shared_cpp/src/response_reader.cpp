@@ -0,0 +1,210 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "fastrtps/config.h"
+#include "fastrtps/Domain.h"
+#include "fastrtps/subscriber/SampleInfo.h"
+
+#include "rmw_fastrtps_shared_cpp/response_reader.hpp"
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+namespace
+{
+bool
+_same_time(const rmw_time_t & a, const rmw_time_t & b)
+{
+  return a.sec == b.sec && a.nsec == b.nsec;
+}
+
+bool
+_same_qos(const rmw_qos_profile_t & a, const rmw_qos_profile_t & b)
+{
+  return a.history == b.history &&
+         a.depth == b.depth &&
+         a.reliability == b.reliability &&
+         a.durability == b.durability &&
+         _same_time(a.deadline, b.deadline) &&
+         _same_time(a.lifespan, b.lifespan) &&
+         a.liveliness == b.liveliness &&
+         _same_time(a.liveliness_lease_duration, b.liveliness_lease_duration);
+}
+}  // namespace
+
+namespace rmw_fastrtps_shared_cpp
+{
+
+void
+ResponseReader::onNewDataMessage(eprosima::fastrtps::Subscriber * sub)
+{
+  assert(sub);
+
+  CustomClientResponse response;
+  if (isNextResponseRouted(sub)) {
+    response.buffer_ = acquireBuffer();
+  }
+  eprosima::fastrtps::SampleInfo_t sinfo;
+
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.is_cdr_buffer = true;
+  // without a buffer, the response is discarded without copying it
+  data.data = response.buffer_.get();
+  data.impl = nullptr;    // not used when is_cdr_buffer is true
+  if (sub->takeNextData(&data, &sinfo)) {
+    if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind && response.buffer_) {
+      response.sample_identity_ = sinfo.related_sample_identity;
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto client = clients_.find(response.sample_identity_.writer_guid());
+      if (client != clients_.end()) {
+        client->second->pushResponse(response);
+      }
+    }
+  }
+  if (response.buffer_) {
+    // Not queued, the buffer can be used for the next response already
+    returnBuffer(std::move(response.buffer_));
+  }
+}
+
+bool
+ResponseReader::isNextResponseRouted(eprosima::fastrtps::Subscriber * sub)
+{
+#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 10
+  // The sample info of a response is only known once it is taken
+  (void)sub;
+  return true;
+#else
+  eprosima::fastrtps::SampleInfo_t sinfo;
+  if (!sub->get_first_untaken_info(&sinfo)) {
+    return true;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto client = clients_.find(sinfo.related_sample_identity.writer_guid());
+  return client != clients_.end() &&
+         client->second->expectsResponse(sinfo.related_sample_identity);
+#endif
+}
+
+void
+ResponseReader::onSubscriptionMatched(
+  eprosima::fastrtps::Subscriber * sub,
+  eprosima::fastrtps::rtps::MatchingInfo & info)
+{
+  (void)sub;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (eprosima::fastrtps::rtps::MATCHED_MATCHING == info.status) {
+    publishers_.insert(info.remoteEndpointGuid);
+  } else if (eprosima::fastrtps::rtps::REMOVED_MATCHING == info.status) {
+    publishers_.erase(info.remoteEndpointGuid);
+  } else {
+    return;
+  }
+  for (auto & client : clients_) {
+    client.second->responsePublishersMatched(publishers_.size());
+  }
+}
+
+void
+ResponseReader::addClient(
+  const eprosima::fastrtps::rtps::GUID_t & writer_guid,
+  ClientListener * listener)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_[writer_guid] = listener;
+  // The reader may be matched already, when it is shared with other clients
+  listener->responsePublishersMatched(publishers_.size());
+}
+
+void
+ResponseReader::removeClient(const eprosima::fastrtps::rtps::GUID_t & writer_guid)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(writer_guid);
+}
+
+void
+ResponseReader::returnBuffer(std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_.push_back(std::move(buffer));
+}
+
+std::unique_ptr<eprosima::fastcdr::FastBuffer>
+ResponseReader::acquireBuffer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!buffers_.empty()) {
+      std::unique_ptr<eprosima::fastcdr::FastBuffer> buffer = std::move(buffers_.back());
+      buffers_.pop_back();
+      return buffer;
+    }
+  }
+  return std::unique_ptr<eprosima::fastcdr::FastBuffer>(new eprosima::fastcdr::FastBuffer());
+}
+
+std::shared_ptr<ResponseReader>
+ResponseReaders::acquire(
+  eprosima::fastrtps::Participant * participant,
+  const eprosima::fastrtps::SubscriberAttributes & attributes,
+  const rmw_qos_profile_t & qos)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string topic_name(attributes.topic.getTopicName());
+  std::string type_name(attributes.topic.topicDataType);
+  auto range = readers_.equal_range(topic_name);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.type_name == type_name &&
+      _same_qos(it->second.qos, qos))
+    {
+      ++it->second.ref_count;
+      return it->second.reader;
+    }
+  }
+
+  std::shared_ptr<ResponseReader> reader = std::make_shared<ResponseReader>();
+  reader->subscriber_ =
+    eprosima::fastrtps::Domain::createSubscriber(participant, attributes, reader.get());
+  if (!reader->subscriber_) {
+    return nullptr;
+  }
+  readers_.emplace(topic_name, Entry {type_name, qos, reader, 1u});
+  return reader;
+}
+
+void
+ResponseReaders::release(const std::shared_ptr<ResponseReader> & reader)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = readers_.begin(); it != readers_.end(); ++it) {
+    if (it->second.reader != reader) {
+      continue;
+    }
+    if (--it->second.ref_count == 0) {
+      // No more callbacks once the subscriber is removed
+      eprosima::fastrtps::Domain::removeSubscriber(reader->subscriber_);
+      reader->subscriber_ = nullptr;
+      readers_.erase(it);
+    }
+    return;
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
@@ -0,0 +1,139 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cassert>
+#include <new>
+
+#include "rmw/error_handling.h"
+#include "rmw/impl/cpp/macros.hpp"
+#include "rmw/rmw.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_allocation_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+
+namespace
+{
+template<typename AllocationT>
+rmw_ret_t
+_init_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  bool reserve_buffer,
+  AllocationT * allocation)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+
+  auto info = new (std::nothrow) CustomAllocationInfo();
+  if (!info) {
+    RMW_SET_ERROR_MSG("failed to allocate CustomAllocationInfo");
+    return RMW_RET_BAD_ALLOC;
+  }
+  info->max_serialized_size_ = max_serialized_size;
+  if (reserve_buffer && !info->buffer_.reserve(max_serialized_size)) {
+    delete info;
+    RMW_SET_ERROR_MSG("failed to allocate the serialization buffer");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  allocation->implementation_identifier = identifier;
+  allocation->data = info;
+  return RMW_RET_OK;
+}
+
+template<typename AllocationT>
+rmw_ret_t
+_fini_allocation(
+  const char * identifier,
+  AllocationT * allocation)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation,
+    allocation->implementation_identifier,
+    identifier,
+    return RMW_RET_ERROR);
+
+  delete static_cast<CustomAllocationInfo *>(allocation->data);
+  allocation->implementation_identifier = nullptr;
+  allocation->data = nullptr;
+  return RMW_RET_OK;
+}
+
+template<typename AllocationT>
+CustomAllocationInfo *
+_get_allocation_info(
+  const char * identifier,
+  AllocationT * allocation)
+{
+  assert(allocation);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation,
+    allocation->implementation_identifier,
+    identifier,
+    return nullptr);
+
+  auto info = static_cast<CustomAllocationInfo *>(allocation->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom allocation info is null", return nullptr);
+  return info;
+}
+}  // namespace
+
+namespace rmw_fastrtps_shared_cpp
+{
+CustomAllocationInfo *
+get_allocation_info(const char * identifier, rmw_publisher_allocation_t * allocation)
+{
+  return _get_allocation_info(identifier, allocation);
+}
+
+CustomAllocationInfo *
+get_allocation_info(const char * identifier, rmw_subscription_allocation_t * allocation)
+{
+  return _get_allocation_info(identifier, allocation);
+}
+
+rmw_ret_t
+__rmw_init_publisher_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_publisher_allocation_t * allocation)
+{
+  return _init_allocation(identifier, max_serialized_size, false, allocation);
+}
+
+rmw_ret_t
+__rmw_fini_publisher_allocation(
+  const char * identifier,
+  rmw_publisher_allocation_t * allocation)
+{
+  return _fini_allocation(identifier, allocation);
+}
+
+rmw_ret_t
+__rmw_init_subscription_allocation(
+  const char * identifier,
+  size_t max_serialized_size,
+  rmw_subscription_allocation_t * allocation)
+{
+  return _init_allocation(identifier, max_serialized_size, true, allocation);
+}
+
+rmw_ret_t
+__rmw_fini_subscription_allocation(
+  const char * identifier,
+  rmw_subscription_allocation_t * allocation)
+{
+  return _fini_allocation(identifier, allocation);
+}
+}  // namespace rmw_fastrtps_shared_cpp
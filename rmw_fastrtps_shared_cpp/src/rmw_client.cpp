@@ -23,9 +23,12 @@
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/qos.hpp"
+#include "rmw_fastrtps_shared_cpp/response_reader.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -50,8 +53,13 @@ __rmw_destroy_client(
 
   auto info = static_cast<CustomClientInfo *>(client->data);
   if (info != nullptr) {
-    if (info->response_subscriber_ != nullptr) {
-      Domain::removeSubscriber(info->response_subscriber_);
+    // Make sure no wait set keeps a reference to the listener
+    if (info->listener_ != nullptr) {
+      clean_wait_set_caches(info->listener_->getReadyListEntry());
+    }
+    if (info->response_reader_) {
+      info->response_reader_->removeClient(info->writer_guid_);
+      info->response_readers_->release(info->response_reader_);
     }
     if (info->request_publisher_ != nullptr) {
       Domain::removePublisher(info->request_publisher_);
@@ -17,6 +17,7 @@
 #include <vector>
 #include <mutex>
 #include <numeric>
+#include <shared_mutex>
 
 #include "rcutils/logging_macros.h"
 
@@ -66,13 +67,22 @@ __rmw_count_publishers(
 
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
   *count = 0;
-  ::ParticipantListener * slave_target = impl->listener;
+  GraphCache * slave_target = impl->graph_cache.get();
+  // A name which is not interned is not the one of any topic.
+  // Look the names up before taking the lock, not to hold it while waiting for the interner.
+  std::vector<InternedString> interned_topic_fqdns;
+  for (const auto & topic_fqdn : topic_fqdns) {
+    InternedString interned_topic_fqdn;
+    if (InternedString::find(topic_fqdn, interned_topic_fqdn)) {
+      interned_topic_fqdns.push_back(interned_topic_fqdn);
+    }
+  }
   {
-    std::lock_guard<std::mutex> guard(slave_target->writer_topic_cache.getMutex());
+    std::shared_lock<SharedMutex> guard(slave_target->writer_topic_cache.getMutex());
     // Search and sum up the publisher counts
-    auto & topic_types = slave_target->writer_topic_cache().getTopicToTypes();
-    for (const auto & topic_fqdn : topic_fqdns) {
-      const auto & it = topic_types.find(topic_fqdn);
+    const auto & topic_types = slave_target->writer_topic_cache().getTopicToTypes();
+    for (const auto & interned_topic_fqdn : interned_topic_fqdns) {
+      const auto & it = topic_types.find(interned_topic_fqdn);
       if (it != topic_types.end()) {
         *count += it->second.size();
       }
@@ -121,13 +131,22 @@ __rmw_count_subscribers(
 
   CustomParticipantInfo * impl = static_cast<CustomParticipantInfo *>(node->data);
   *count = 0;
-  ::ParticipantListener * slave_target = impl->listener;
+  GraphCache * slave_target = impl->graph_cache.get();
+  // A name which is not interned is not the one of any topic.
+  // Look the names up before taking the lock, not to hold it while waiting for the interner.
+  std::vector<InternedString> interned_topic_fqdns;
+  for (const auto & topic_fqdn : topic_fqdns) {
+    InternedString interned_topic_fqdn;
+    if (InternedString::find(topic_fqdn, interned_topic_fqdn)) {
+      interned_topic_fqdns.push_back(interned_topic_fqdn);
+    }
+  }
   {
-    std::lock_guard<std::mutex> guard(slave_target->reader_topic_cache.getMutex());
+    std::shared_lock<SharedMutex> guard(slave_target->reader_topic_cache.getMutex());
     // Search and sum up the subscriber counts
-    auto & topic_types = slave_target->reader_topic_cache().getTopicToTypes();
-    for (const auto & topic_fqdn : topic_fqdns) {
-      const auto & it = topic_types.find(topic_fqdn);
+    const auto & topic_types = slave_target->reader_topic_cache().getTopicToTypes();
+    for (const auto & interned_topic_fqdn : interned_topic_fqdns) {
+      const auto & it = topic_types.find(interned_topic_fqdn);
       if (it != topic_types.end()) {
         *count += it->second.size();
       }
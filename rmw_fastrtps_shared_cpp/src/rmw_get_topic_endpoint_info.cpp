@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <map>
+#include <shared_mutex>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -23,7 +24,6 @@
 #include "rmw/topic_endpoint_info_array.h"
 #include "rmw/topic_endpoint_info.h"
 
-#include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 #include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
@@ -121,10 +121,10 @@ _set_rmw_topic_endpoint_info(
   const GUID_t & participant_guid,
   const char * node_name,
   const char * node_namespace,
-  TopicData topic_data,
-  bool no_mangle,
+  const TopicData & topic_data,
+  const std::string & type_name,
   bool is_publisher,
-  ::ParticipantListener * slave_target,
+  GraphCache * slave_target,
   rcutils_allocator_t * allocator)
 {
   static_assert(
@@ -158,8 +158,6 @@ _set_rmw_topic_endpoint_info(
     return ret;
   }
   // set topic type
-  std::string type_name =
-    no_mangle ? topic_data.topic_type : _demangle_if_ros_type(topic_data.topic_type);
   ret = rmw_topic_endpoint_info_set_topic_type(topic_endpoint_info, type_name.c_str(), allocator);
   if (ret != RMW_RET_OK) {
     return ret;
@@ -178,30 +176,24 @@ _set_rmw_topic_endpoint_info(
     return ret;
   }
   // This means that this discovered participant is not associated with the passed node
-  // and hence we must find its name and namespace from the discovered_names and
-  // discovered_namespace maps
-  // set node name
-  const auto & d_name_it = slave_target->discovered_names.find(topic_data.participant_guid);
-  if (d_name_it != slave_target->discovered_names.end()) {
-    ret = rmw_topic_endpoint_info_set_node_name(
-      topic_endpoint_info, d_name_it->second.c_str(), allocator);
-  } else {
-    ret = rmw_topic_endpoint_info_set_node_name(
-      topic_endpoint_info, "_NODE_NAME_UNKNOWN_", allocator);
+  // and hence we must find its name and namespace from the discovered nodes
+  std::string discovered_name;
+  std::string discovered_namespace;
+  if (!slave_target->get_node_name(
+      topic_data.participant_guid, discovered_name, discovered_namespace))
+  {
+    discovered_name = "_NODE_NAME_UNKNOWN_";
+    discovered_namespace = "_NODE_NAMESPACE_UNKNOWN_";
   }
+  // set node name
+  ret = rmw_topic_endpoint_info_set_node_name(
+    topic_endpoint_info, discovered_name.c_str(), allocator);
   if (ret != RMW_RET_OK) {
     return ret;
   }
   // set node namespace
-  const auto & d_namespace_it =
-    slave_target->discovered_namespaces.find(topic_data.participant_guid);
-  if (d_namespace_it != slave_target->discovered_namespaces.end()) {
-    ret = rmw_topic_endpoint_info_set_node_namespace(
-      topic_endpoint_info, d_namespace_it->second.c_str(), allocator);
-  } else {
-    ret = rmw_topic_endpoint_info_set_node_namespace(
-      topic_endpoint_info, "_NODE_NAMESPACE_UNKNOWN_", allocator);
-  }
+  ret = rmw_topic_endpoint_info_set_node_namespace(
+    topic_endpoint_info, discovered_namespace.c_str(), allocator);
   return ret;
 }
 
@@ -228,19 +220,28 @@ _get_info_by_topic(
 
   const auto & topic_fqdns = _get_topic_fqdns(topic_name, no_mangle);
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
-  // The GUID of the participant associated with this node
-  const auto & participant_guid = impl->participant->getGuid();
+  // The key of this node in the topic caches
+  const auto & participant_guid = impl->node_guid;
   const auto & node_name = node->name;
   const auto & node_namespace = node->namespace_;
-  ::ParticipantListener * slave_target = impl->listener;
+  GraphCache * slave_target = impl->graph_cache.get();
   auto & topic_cache =
     is_publisher ? slave_target->writer_topic_cache : slave_target->reader_topic_cache;
+  // A name which is not interned is not the one of any topic.
+  // Look the names up before taking the lock, not to hold it while waiting for the interner.
+  std::vector<InternedString> interned_topic_names;
+  for (const auto & topic_name : topic_fqdns) {
+    InternedString interned_topic_name;
+    if (InternedString::find(topic_name, interned_topic_name)) {
+      interned_topic_names.push_back(interned_topic_name);
+    }
+  }
   {
-    std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+    std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
     const auto & topic_name_to_data = topic_cache().getTopicNameToTopicData();
     std::vector<rmw_topic_endpoint_info_t> topic_endpoint_info_vector;
-    for (const auto & topic_name : topic_fqdns) {
-      const auto it = topic_name_to_data.find(topic_name);
+    for (const auto & interned_topic_name : interned_topic_names) {
+      const auto it = topic_name_to_data.find(interned_topic_name);
       if (it != topic_name_to_data.end()) {
         for (const auto & data : it->second) {
           rmw_topic_endpoint_info_t topic_endpoint_info =
@@ -251,7 +252,8 @@ _get_info_by_topic(
             node_name,
             node_namespace,
             data,
-            no_mangle,
+            no_mangle ? data.topic_type.str() :
+            topic_cache().getDemangledType(data.topic_type).type_name,
             is_publisher,
             slave_target,
             allocator);
@@ -12,7 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <set>
 #include <string>
@@ -47,7 +51,9 @@
 #include "fastrtps/rtps/builtin/discovery/endpoint/EDPSimple.h"
 
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
+#include "rmw_fastrtps_shared_cpp/response_reader.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_context_impl.hpp"
 
 using Domain = eprosima::fastrtps::Domain;
 using IPLocator = eprosima::fastrtps::rtps::IPLocator;
@@ -56,130 +62,45 @@ using Participant = eprosima::fastrtps::Participant;
 using ParticipantAttributes = eprosima::fastrtps::ParticipantAttributes;
 using StatefulReader = eprosima::fastrtps::rtps::StatefulReader;
 
-namespace rmw_fastrtps_shared_cpp
+namespace
 {
-rmw_node_t *
-create_node(
-  const char * identifier,
-  const char * name,
-  const char * namespace_,
-  ParticipantAttributes participantAttrs)
+// Type of the node announcement publishers, which are only discovered and never written to.
+class NodeAnnouncementType : public eprosima::fastrtps::TopicDataType
 {
-  if (!name) {
-    RMW_SET_ERROR_MSG("name is null");
-    return nullptr;
+public:
+  NodeAnnouncementType()
+  {
+    setName("rmw_fastrtps_shared_cpp::NodeAnnouncement");
+    m_typeSize = 0;
+    m_isGetKeyDefined = false;
   }
 
-  if (!namespace_) {
-    RMW_SET_ERROR_MSG("namespace_ is null");
-    return nullptr;
+  bool serialize(void *, eprosima::fastrtps::rtps::SerializedPayload_t *) override
+  {
+    return false;
   }
 
-  // Declare everything before beginning to create things.
-  ::ParticipantListener * listener = nullptr;
-  Participant * participant = nullptr;
-  rmw_guard_condition_t * graph_guard_condition = nullptr;
-  CustomParticipantInfo * node_impl = nullptr;
-  rmw_node_t * node_handle = nullptr;
-
-  graph_guard_condition = __rmw_create_guard_condition(identifier);
-  if (!graph_guard_condition) {
-    // error already set
-    goto fail;
+  bool deserialize(eprosima::fastrtps::rtps::SerializedPayload_t *, void *) override
+  {
+    return false;
   }
 
-  try {
-    listener = new ::ParticipantListener(graph_guard_condition);
-  } catch (std::bad_alloc &) {
-    RMW_SET_ERROR_MSG("failed to allocate participant listener");
-    goto fail;
+  std::function<uint32_t()> getSerializedSizeProvider(void *) override
+  {
+    return []() {return 0u;};
   }
 
-  participant = Domain::createParticipant(participantAttrs, listener);
-  if (!participant) {
-    RMW_SET_ERROR_MSG("create_node() could not create participant");
+  void * createData() override
+  {
     return nullptr;
   }
 
-  try {
-    node_impl = new CustomParticipantInfo();
-
-    node_impl->leave_middleware_default_qos = false;
-    const char * env_var = "RMW_FASTRTPS_USE_QOS_FROM_XML";
-    // Check if the configuration from XML has been enabled from
-    // the RMW_FASTRTPS_USE_QOS_FROM_XML env variable.
-    char * config_env_val = nullptr;
-#ifndef _WIN32
-    config_env_val = getenv(env_var);
-    if (config_env_val != nullptr) {
-      node_impl->leave_middleware_default_qos = strcmp(config_env_val, "1") == 0;
-    }
-#else
-    size_t config_env_val_size;
-    _dupenv_s(&config_env_val, &config_env_val_size, env_var);
-    if (config_env_val != nullptr) {
-      node_impl->leave_middleware_default_qos = strcmp(config_env_val, "1") == 0;
-    }
-    free(config_env_val);
-#endif
-  } catch (std::bad_alloc &) {
-    RMW_SET_ERROR_MSG("failed to allocate node impl struct");
-    goto fail;
-  }
-
-  node_handle = rmw_node_allocate();
-  if (!node_handle) {
-    RMW_SET_ERROR_MSG("failed to allocate rmw_node_t");
-    goto fail;
-  }
-  node_handle->implementation_identifier = identifier;
-  node_impl->participant = participant;
-  node_impl->listener = listener;
-  node_impl->graph_guard_condition = graph_guard_condition;
-  node_handle->data = node_impl;
-
-  node_handle->name =
-    static_cast<const char *>(rmw_allocate(sizeof(char) * strlen(name) + 1));
-  if (!node_handle->name) {
-    RMW_SET_ERROR_MSG("failed to allocate memory");
-    node_handle->namespace_ = nullptr;  // to avoid free on uninitialized memory
-    goto fail;
-  }
-  memcpy(const_cast<char *>(node_handle->name), name, strlen(name) + 1);
-
-  node_handle->namespace_ =
-    static_cast<const char *>(rmw_allocate(sizeof(char) * strlen(namespace_) + 1));
-  if (!node_handle->namespace_) {
-    RMW_SET_ERROR_MSG("failed to allocate memory");
-    goto fail;
-  }
-  memcpy(const_cast<char *>(node_handle->namespace_), namespace_, strlen(namespace_) + 1);
-
-  return node_handle;
-fail:
-  if (node_handle) {
-    rmw_free(const_cast<char *>(node_handle->namespace_));
-    node_handle->namespace_ = nullptr;
-    rmw_free(const_cast<char *>(node_handle->name));
-    node_handle->name = nullptr;
-  }
-  rmw_node_free(node_handle);
-  delete node_impl;
-  if (graph_guard_condition) {
-    rmw_ret_t ret = __rmw_destroy_guard_condition(graph_guard_condition);
-    if (ret != RMW_RET_OK) {
-      RCUTILS_LOG_ERROR_NAMED(
-        "rmw_fastrtps_shared_cpp",
-        "failed to destroy guard condition during error handling");
-    }
-  }
-  rmw_free(listener);
-  if (participant) {
-    Domain::removeParticipant(participant);
-  }
-  return nullptr;
-}
+  void deleteData(void *) override {}
+};
+}  // namespace
 
+namespace rmw_fastrtps_shared_cpp
+{
 bool
 get_security_file_paths(
   std::array<std::string, 6> & security_files_paths, const char * node_secure_root)
@@ -214,32 +135,23 @@ get_security_file_paths(
   return true;
 }
 
-rmw_node_t *
-__rmw_create_node(
-  const char * identifier,
+/**
+ * Create a participant, to be shared by the nodes of a context created with the same options.
+ */
+ContextParticipant *
+create_participant(
   const char * name,
   const char * namespace_,
   size_t domain_id,
   const rmw_node_security_options_t * security_options,
   bool localhost_only)
 {
-  if (!name) {
-    RMW_SET_ERROR_MSG("name is null");
-    return nullptr;
-  }
-  if (!security_options) {
-    RMW_SET_ERROR_MSG("security_options is null");
-    return nullptr;
-  }
-
   ParticipantAttributes participantAttrs;
 
   // Load default XML profile.
   Domain::getDefaultParticipantAttributes(participantAttrs);
 
   participantAttrs.rtps.builtin.domainId = static_cast<uint32_t>(domain_id);
-  // since the participant name is not part of the DDS spec
-  participantAttrs.rtps.setName(name);
 
   if (localhost_only) {
     Locator_t local_network_interface_locator;
@@ -278,15 +190,12 @@ __rmw_create_node(
       eprosima::fastrtps::rtps::PREALLOCATED_WITH_REALLOC_MEMORY_MODE;
   }
 
-  size_t length = strlen(name) + strlen("name=;") +
-    strlen(namespace_) + strlen("namespace=;") + 1;
-  participantAttrs.rtps.userData.resize(length);
-  int written = snprintf(reinterpret_cast<char *>(participantAttrs.rtps.userData.data()),
-      length, "name=%s;namespace=%s;", name, namespace_);
-  if (written < 0 || written > static_cast<int>(length) - 1) {
-    RMW_SET_ERROR_MSG("failed to populate user_data buffer");
-    return nullptr;
-  }
+  // The participant is shared by several nodes, which are named in the user data of their
+  // endpoints and node announcements instead. The participant user data cannot change once
+  // created, so peers which predate this only see the node which created the participant.
+  const std::string nodes_user_data =
+    std::string("name=") + name + ";namespace=" + namespace_ + ";nodes=endpoints;";
+  participantAttrs.rtps.userData.assign(nodes_user_data.begin(), nodes_user_data.end());
 
   if (security_options->security_root_path) {
     // if security_root_path provided, try to find the key and certificate files
@@ -331,7 +240,291 @@ __rmw_create_node(
     return nullptr;
 #endif
   }
-  return create_node(identifier, name, namespace_, participantAttrs);
+
+  // Declare everything before beginning to create things.
+  std::shared_ptr<GraphCache> graph_cache;
+  std::shared_ptr<ResponseReaders> response_readers;
+  ::ParticipantListener * listener = nullptr;
+  NodeAnnouncementType * node_announcement_type = nullptr;
+  Participant * participant = nullptr;
+  ContextParticipant * context_participant = nullptr;
+
+  try {
+    graph_cache = GraphCache::get_for_domain(domain_id, localhost_only);
+    listener = new ::ParticipantListener(graph_cache);
+    node_announcement_type = new NodeAnnouncementType();
+    response_readers = std::make_shared<ResponseReaders>();
+  } catch (std::bad_alloc &) {
+    RMW_SET_ERROR_MSG("failed to allocate participant listener");
+    goto fail;
+  }
+
+  participant = Domain::createParticipant(participantAttrs, listener);
+  if (!participant) {
+    RMW_SET_ERROR_MSG("create_node() could not create participant");
+    goto fail;
+  }
+
+  if (!Domain::registerType(participant, node_announcement_type)) {
+    RMW_SET_ERROR_MSG("create_node() could not register node announcement type");
+    goto fail;
+  }
+
+  try {
+    context_participant = new ContextParticipant();
+  } catch (std::bad_alloc &) {
+    RMW_SET_ERROR_MSG("failed to allocate context participant");
+    goto fail;
+  }
+  context_participant->domain_id = domain_id;
+  context_participant->localhost_only = localhost_only;
+  if (security_options->security_root_path) {
+    context_participant->security_root_path = security_options->security_root_path;
+  }
+  context_participant->enforce_security = security_options->enforce_security;
+  context_participant->participant = participant;
+  context_participant->listener = listener;
+  context_participant->node_announcement_type = node_announcement_type;
+  context_participant->graph_cache = graph_cache;
+  context_participant->response_readers = response_readers;
+  context_participant->node_count = 0;
+  return context_participant;
+fail:
+  if (participant) {
+    Domain::removeParticipant(participant);
+  }
+  delete node_announcement_type;
+  delete listener;
+  return nullptr;
+}
+
+/**
+ * Remove a participant which is not used by any node anymore from its context.
+ *
+ * Must be called with the mutex of the context held.
+ */
+void
+destroy_participant(rmw_context_impl_t * context_impl, ContextParticipant * context_participant)
+{
+  Domain::removeParticipant(context_participant->participant);
+  delete context_participant->node_announcement_type;
+  delete context_participant->listener;
+  auto & participants = context_impl->participants;
+  participants.erase(
+    std::find_if(
+      participants.begin(), participants.end(),
+      [context_participant](const std::unique_ptr<ContextParticipant> & candidate) {
+        return candidate.get() == context_participant;
+      }));
+}
+
+rmw_node_t *
+create_node(
+  const char * identifier,
+  const char * name,
+  const char * namespace_,
+  rmw_context_impl_t * context_impl,
+  ContextParticipant * context_participant)
+{
+  if (!name) {
+    RMW_SET_ERROR_MSG("name is null");
+    return nullptr;
+  }
+
+  if (!namespace_) {
+    RMW_SET_ERROR_MSG("namespace_ is null");
+    return nullptr;
+  }
+
+  // Declare everything before beginning to create things.
+  rmw_guard_condition_t * graph_guard_condition = nullptr;
+  CustomParticipantInfo * node_impl = nullptr;
+  rmw_node_t * node_handle = nullptr;
+  size_t length = 0;
+  int written = 0;
+
+  graph_guard_condition = __rmw_create_guard_condition(identifier);
+  if (!graph_guard_condition) {
+    // error already set
+    goto fail;
+  }
+
+  try {
+    node_impl = new CustomParticipantInfo();
+
+    node_impl->leave_middleware_default_qos = false;
+    const char * env_var = "RMW_FASTRTPS_USE_QOS_FROM_XML";
+    // Check if the configuration from XML has been enabled from
+    // the RMW_FASTRTPS_USE_QOS_FROM_XML env variable.
+    char * config_env_val = nullptr;
+#ifndef _WIN32
+    config_env_val = getenv(env_var);
+    if (config_env_val != nullptr) {
+      node_impl->leave_middleware_default_qos = strcmp(config_env_val, "1") == 0;
+    }
+#else
+    size_t config_env_val_size;
+    _dupenv_s(&config_env_val, &config_env_val_size, env_var);
+    if (config_env_val != nullptr) {
+      node_impl->leave_middleware_default_qos = strcmp(config_env_val, "1") == 0;
+    }
+    free(config_env_val);
+#endif
+
+    length = strlen(name) + strlen("name=;") +
+      strlen(namespace_) + strlen("namespace=;") + 1;
+    node_impl->node_user_data.resize(length);
+  } catch (std::bad_alloc &) {
+    RMW_SET_ERROR_MSG("failed to allocate node impl struct");
+    goto fail;
+  }
+
+  written = snprintf(reinterpret_cast<char *>(node_impl->node_user_data.data()),
+      length, "name=%s;namespace=%s;", name, namespace_);
+  if (written < 0 || written > static_cast<int>(length) - 1) {
+    RMW_SET_ERROR_MSG("failed to populate user_data buffer");
+    goto fail;
+  }
+  // the terminating null character is not part of the user data
+  node_impl->node_user_data.resize(length - 1);
+
+  {
+    eprosima::fastrtps::PublisherAttributes announcementParam;
+    Domain::getDefaultPublisherAttributes(announcementParam);
+    announcementParam.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    announcementParam.topic.topicDataType =
+      context_participant->node_announcement_type->getName();
+    announcementParam.topic.topicName = node_announcement_topic_name;
+    announcementParam.qos.m_userData.setDataVec(node_impl->node_user_data);
+    node_impl->node_announcement =
+      Domain::createPublisher(context_participant->participant, announcementParam, nullptr);
+    if (!node_impl->node_announcement) {
+      RMW_SET_ERROR_MSG("create_node() could not create node announcement");
+      goto fail;
+    }
+  }
+
+  node_handle = rmw_node_allocate();
+  if (!node_handle) {
+    RMW_SET_ERROR_MSG("failed to allocate rmw_node_t");
+    goto fail;
+  }
+  node_handle->implementation_identifier = identifier;
+  node_impl->participant = context_participant->participant;
+  node_impl->listener = context_participant->listener;
+  node_impl->graph_cache = context_participant->graph_cache;
+  node_impl->response_readers = context_participant->response_readers;
+  node_impl->graph_guard_condition = graph_guard_condition;
+  node_impl->context_impl = context_impl;
+  node_handle->data = node_impl;
+
+  node_handle->name =
+    static_cast<const char *>(rmw_allocate(sizeof(char) * strlen(name) + 1));
+  if (!node_handle->name) {
+    RMW_SET_ERROR_MSG("failed to allocate memory");
+    node_handle->namespace_ = nullptr;  // to avoid free on uninitialized memory
+    goto fail;
+  }
+  memcpy(const_cast<char *>(node_handle->name), name, strlen(name) + 1);
+
+  node_handle->namespace_ =
+    static_cast<const char *>(rmw_allocate(sizeof(char) * strlen(namespace_) + 1));
+  if (!node_handle->namespace_) {
+    RMW_SET_ERROR_MSG("failed to allocate memory");
+    goto fail;
+  }
+  memcpy(const_cast<char *>(node_handle->namespace_), namespace_, strlen(namespace_) + 1);
+
+  // Nothing can fail anymore, make the node known to the graph cache.
+  node_impl->node_guid = node_impl->graph_cache->add_local_node(
+    context_participant->participant->getGuid(), name, namespace_);
+  node_impl->graph_cache->add_graph_guard_condition(graph_guard_condition);
+  ++context_participant->node_count;
+  node_impl->graph_cache->trigger_graph_guard_conditions();
+
+  return node_handle;
+fail:
+  if (node_handle) {
+    rmw_free(const_cast<char *>(node_handle->namespace_));
+    node_handle->namespace_ = nullptr;
+    rmw_free(const_cast<char *>(node_handle->name));
+    node_handle->name = nullptr;
+  }
+  rmw_node_free(node_handle);
+  if (node_impl && node_impl->node_announcement) {
+    Domain::removePublisher(node_impl->node_announcement);
+  }
+  delete node_impl;
+  if (graph_guard_condition) {
+    rmw_ret_t ret = __rmw_destroy_guard_condition(graph_guard_condition);
+    if (ret != RMW_RET_OK) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rmw_fastrtps_shared_cpp",
+        "failed to destroy guard condition during error handling");
+    }
+  }
+  return nullptr;
+}
+
+rmw_node_t *
+__rmw_create_node(
+  const char * identifier,
+  rmw_context_t * context,
+  const char * name,
+  const char * namespace_,
+  size_t domain_id,
+  const rmw_node_security_options_t * security_options,
+  bool localhost_only)
+{
+  if (!name) {
+    RMW_SET_ERROR_MSG("name is null");
+    return nullptr;
+  }
+  if (!security_options) {
+    RMW_SET_ERROR_MSG("security_options is null");
+    return nullptr;
+  }
+  if (!context->impl) {
+    RMW_SET_ERROR_MSG("context impl is null");
+    return nullptr;
+  }
+
+  rmw_context_impl_t * context_impl = context->impl;
+  std::lock_guard<std::mutex> guard(context_impl->mutex);
+
+  // Share the participant of another node of the context, if created with the same options.
+  std::string security_root_path;
+  if (security_options->security_root_path) {
+    security_root_path = security_options->security_root_path;
+  }
+  bool enforce_security = security_options->enforce_security;
+  ContextParticipant * context_participant = nullptr;
+  for (const auto & candidate : context_impl->participants) {
+    if (candidate->domain_id == domain_id &&
+      candidate->localhost_only == localhost_only &&
+      candidate->security_root_path == security_root_path &&
+      candidate->enforce_security == enforce_security)
+    {
+      context_participant = candidate.get();
+      break;
+    }
+  }
+  if (!context_participant) {
+    context_participant =
+      create_participant(name, namespace_, domain_id, security_options, localhost_only);
+    if (!context_participant) {
+      // error already set
+      return nullptr;
+    }
+    context_impl->participants.emplace_back(context_participant);
+  }
+
+  rmw_node_t * node_handle =
+    create_node(identifier, name, namespace_, context_impl, context_participant);
+  if (!node_handle && 0u == context_participant->node_count) {
+    destroy_participant(context_impl, context_participant);
+  }
+  return node_handle;
 }
 
 rmw_ret_t
@@ -356,7 +549,25 @@ __rmw_destroy_node(
     return RMW_RET_ERROR;
   }
 
-  Participant * participant = impl->participant;
+  {
+    std::lock_guard<std::mutex> guard(impl->context_impl->mutex);
+    Domain::removePublisher(impl->node_announcement);
+    impl->node_announcement = nullptr;
+    impl->graph_cache->remove_graph_guard_condition(impl->graph_guard_condition);
+    impl->graph_cache->remove_local_node(impl->node_guid);
+    impl->graph_cache->trigger_graph_guard_conditions();
+    // Remove the participant along with the last node using it.
+    for (const auto & context_participant : impl->context_impl->participants) {
+      if (context_participant->participant == impl->participant) {
+        if (0u == --context_participant->node_count) {
+          destroy_participant(impl->context_impl, context_participant.get());
+        }
+        break;
+      }
+    }
+  }
+  impl->participant = nullptr;
+  impl->listener = nullptr;
 
   // Begin deleting things in the same order they were created in __rmw_create_node().
   rmw_free(const_cast<char *>(node->name));
@@ -365,15 +576,11 @@ __rmw_destroy_node(
   node->namespace_ = nullptr;
   rmw_node_free(node);
 
-  Domain::removeParticipant(participant);
-
   if (RMW_RET_OK != __rmw_destroy_guard_condition(impl->graph_guard_condition)) {
     RMW_SET_ERROR_MSG("failed to destroy graph guard condition");
     result_ret = RMW_RET_ERROR;
   }
 
-  delete impl->listener;
-  impl->listener = nullptr;
   delete impl;
 
   return result_ret;
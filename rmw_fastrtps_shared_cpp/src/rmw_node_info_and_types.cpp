@@ -15,6 +15,7 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 
@@ -32,9 +33,7 @@
 #include "rmw/names_and_types.h"
 #include "rmw/rmw.h"
 
-#include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
-#include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "rmw_fastrtps_shared_cpp/topic_cache.hpp"
@@ -60,35 +59,14 @@ rmw_ret_t __get_guid_by_name(
 {
   auto impl = static_cast<CustomParticipantInfo *>(node->data);
   if (strcmp(node->name, node_name) == 0 && strcmp(node->namespace_, node_namespace) == 0) {
-    guid = impl->participant->getGuid();
-  } else {
-    std::set<GUID_t> nodes_in_desired_namespace;
-    std::lock_guard<std::mutex> guard(impl->listener->names_mutex_);
-
-    auto namespaces = impl->listener->discovered_namespaces;
-    for (auto & guid_to_namespace : impl->listener->discovered_namespaces) {
-      if (guid_to_namespace.second == node_namespace) {
-        nodes_in_desired_namespace.insert(guid_to_namespace.first);
-      }
-    }
-
-    auto guid_node_pair = std::find_if(impl->listener->discovered_names.begin(),
-        impl->listener->discovered_names.end(),
-        [node_name, &nodes_in_desired_namespace](const std::pair<const GUID_t,
-        std::string> & pair) {
-          return pair.second == node_name &&
-          nodes_in_desired_namespace.find(pair.first) != nodes_in_desired_namespace.end();
-        });
-
-    if (guid_node_pair == impl->listener->discovered_names.end()) {
-      RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
-        "Node name not found: ns='%s', name='%s'",
-        node_namespace,
-        node_name
-      );
-      return RMW_RET_NODE_NAME_NON_EXISTENT;
-    }
-    guid = guid_node_pair->first;
+    guid = impl->node_guid;
+  } else if (!impl->graph_cache->get_node_guid(node_name, node_namespace, guid)) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "Node name not found: ns='%s', name='%s'",
+      node_namespace,
+      node_name
+    );
+    return RMW_RET_NODE_NAME_NON_EXISTENT;
   }
   return RMW_RET_OK;
 }
@@ -157,7 +135,7 @@ __accumulate_topics(
   const GUID_t & node_guid_,
   bool no_demangle)
 {
-  std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+  std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
   const auto & node_topics = topic_cache().getParticipantToTopics().find(node_guid_);
   if (node_topics == topic_cache().getParticipantToTopics().end()) {
     RCUTILS_LOG_DEBUG_NAMED(
@@ -166,7 +144,8 @@ __accumulate_topics(
     return;
   }
   for (auto & topic_pair : node_topics->second) {
-    if (!no_demangle && _get_ros_prefix_if_exists(topic_pair.first) != ros_topic_prefix) {
+    const DemangledTopic & demangled_topic = topic_cache().getDemangledTopic(topic_pair.first);
+    if (!no_demangle && !demangled_topic.is_ros_topic) {
       // if we are demangling and this is not prefixed with rt/, skip it
       continue;
     }
@@ -175,8 +154,14 @@ __accumulate_topics(
       "accumulate_topics: Found topic %s",
       topic_pair.first.c_str());
 
-    topics[topic_pair.first].insert(topic_pair.second.begin(),
-      topic_pair.second.end());
+    if (no_demangle) {
+      topics[topic_pair.first].insert(topic_pair.second.begin(), topic_pair.second.end());
+      continue;
+    }
+    auto & types = topics[demangled_topic.topic_name];
+    for (const auto & type : topic_pair.second) {
+      types.insert(topic_cache().getDemangledType(type).type_name);
+    }
   }
 }
 
@@ -185,7 +170,6 @@ __accumulate_topics(
  *
  * \param topics to copy over
  * \param allocator to use
- * \param no_demangle true if demangling will not occur
  * \param topic_names_and_types [out] final rmw result
  * \return RMW_RET_OK if successful
  */
@@ -193,7 +177,6 @@ rmw_ret_t
 __copy_data_to_results(
   const std::map<std::string, std::set<std::string>> & topics,
   rcutils_allocator_t * allocator,
-  bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types)
 {
   // Copy data to results handle
@@ -212,21 +195,11 @@ __copy_data_to_results(
             "error during report of error: %s", rmw_get_error_string().str);
         }
       };
-    // Setup demangling functions based on no_demangle option
-    auto demangle_topic = _demangle_if_ros_topic;
-    auto demangle_type = _demangle_if_ros_type;
-    if (no_demangle) {
-      auto noop = [](const std::string & in) {
-          return in;
-        };
-      demangle_topic = noop;
-      demangle_type = noop;
-    }
     // For each topic, store the name, initialize the string array for types, and store all types
     size_t index = 0;
     for (const auto & topic_n_types : topics) {
       // Duplicate and store the topic_name
-      char * topic_name = rcutils_strdup(demangle_topic(topic_n_types.first).c_str(), *allocator);
+      char * topic_name = rcutils_strdup(topic_n_types.first.c_str(), *allocator);
       if (!topic_name) {
         RMW_SET_ERROR_MSG("failed to allocate memory for topic name");
         fail_cleanup();
@@ -248,7 +221,7 @@ __copy_data_to_results(
       // Duplicate and store each type for the topic
       size_t type_index = 0;
       for (const auto & type : topic_n_types.second) {
-        char * type_name = rcutils_strdup(demangle_type(type).c_str(), *allocator);
+        char * type_name = rcutils_strdup(type.c_str(), *allocator);
         if (!type_name) {
           RMW_SET_ERROR_MSG("failed to allocate memory for type name");
           fail_cleanup();
@@ -268,8 +241,8 @@ __log_debug_information(const CustomParticipantInfo & impl)
 {
   if (rcutils_logging_logger_is_enabled_for(kLoggerTag, RCUTILS_LOG_SEVERITY_DEBUG)) {
     {
-      auto & topic_cache = impl.listener->writer_topic_cache;
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      auto & topic_cache = impl.graph_cache->writer_topic_cache;
+      std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
       std::stringstream map_ss;
       map_ss << topic_cache();
       RCUTILS_LOG_DEBUG_NAMED(
@@ -277,8 +250,8 @@ __log_debug_information(const CustomParticipantInfo & impl)
         "Publisher Topic cache is: %s", map_ss.str().c_str());
     }
     {
-      auto & topic_cache = impl.listener->reader_topic_cache;
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+      auto & topic_cache = impl.graph_cache->reader_topic_cache;
+      std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
       std::stringstream map_ss;
       map_ss << topic_cache();
       RCUTILS_LOG_DEBUG_NAMED(
@@ -287,19 +260,10 @@ __log_debug_information(const CustomParticipantInfo & impl)
     }
     {
       std::stringstream ss;
-      std::lock_guard<std::mutex> guard(impl.listener->names_mutex_);
-      for (auto & node_pair : impl.listener->discovered_names) {
-        ss << node_pair.first << " : " << node_pair.second << " ";
+      for (const auto & node : impl.graph_cache->get_discovered_nodes()) {
+        ss << node.guid << " : " << node.namespace_ << " " << node.name << " ";
       }
-      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered names: %s", ss.str().c_str());
-    }
-    {
-      std::stringstream ss;
-      std::lock_guard<std::mutex> guard(impl.listener->names_mutex_);
-      for (auto & node_pair : impl.listener->discovered_namespaces) {
-        ss << node_pair.first << " : " << node_pair.second << " ";
-      }
-      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered namespaces: %s", ss.str().c_str());
+      RCUTILS_LOG_DEBUG_NAMED(kLoggerTag, "Discovered nodes: %s", ss.str().c_str());
     }
   }
 }
@@ -351,7 +315,7 @@ __rmw_get_topic_names_and_types_by_node(
   }
   std::map<std::string, std::set<std::string>> topics;
   __accumulate_topics(retrieve_cache_func(*impl), topics, guid, no_demangle);
-  return __copy_data_to_results(topics, allocator, no_demangle, topic_names_and_types);
+  return __copy_data_to_results(topics, allocator, topic_names_and_types);
 }
 
 rmw_ret_t
@@ -366,7 +330,7 @@ __rmw_get_subscriber_names_and_types_by_node(
 {
   RetrieveCache retrieve_sub_cache =
     [](CustomParticipantInfo & participant_info) -> const LockedObject<TopicCache> & {
-      return participant_info.listener->reader_topic_cache;
+      return participant_info.graph_cache->reader_topic_cache;
     };
   return __rmw_get_topic_names_and_types_by_node(identifier, node, allocator, node_name,
            node_namespace, no_demangle, retrieve_sub_cache, topic_names_and_types);
@@ -384,7 +348,7 @@ __rmw_get_publisher_names_and_types_by_node(
 {
   RetrieveCache retrieve_pub_cache =
     [](CustomParticipantInfo & participant_info) -> const LockedObject<TopicCache> & {
-      return participant_info.listener->writer_topic_cache;
+      return participant_info.graph_cache->writer_topic_cache;
     };
   return __rmw_get_topic_names_and_types_by_node(identifier, node, allocator, node_name,
            node_namespace, no_demangle, retrieve_pub_cache, topic_names_and_types);
@@ -399,6 +363,7 @@ __get_service_names_and_types_by_node(
   const char * node_name,
   const char * node_namespace,
   rmw_names_and_types_t * service_names_and_types,
+  RetrieveCache & retrieve_cache_func,
   const char * topic_suffix)
 {
   const std::string topic_suffix_stdstr(topic_suffix);
@@ -418,12 +383,13 @@ __get_service_names_and_types_by_node(
 
   std::map<std::string, std::set<std::string>> services;
   {
-    auto & topic_cache = impl->listener->reader_topic_cache;
-    std::lock_guard<std::mutex> guard(topic_cache.getMutex());
+    auto & topic_cache = retrieve_cache_func(*impl);
+    std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
     const auto & node_topics = topic_cache().getParticipantToTopics().find(guid);
     if (node_topics != topic_cache().getParticipantToTopics().end()) {
       for (auto & topic_pair : node_topics->second) {
-        std::string service_name = _demangle_service_from_topic(topic_pair.first);
+        const std::string & service_name =
+          topic_cache().getDemangledTopic(topic_pair.first).service_name;
         if (service_name.empty()) {
           // not a service
           continue;
@@ -438,7 +404,8 @@ __get_service_names_and_types_by_node(
         }
 
         for (auto & itt : topic_pair.second) {
-          std::string service_type = _demangle_service_type_only(itt);
+          const std::string & service_type =
+            topic_cache().getDemangledType(itt).service_type_name;
           if (!service_type.empty()) {
             services[service_name].insert(service_type);
           }
@@ -511,6 +478,10 @@ __rmw_get_service_names_and_types_by_node(
   const char * node_namespace,
   rmw_names_and_types_t * service_names_and_types)
 {
+  RetrieveCache retrieve_sub_cache =
+    [](CustomParticipantInfo & participant_info) -> const LockedObject<TopicCache> & {
+      return participant_info.graph_cache->reader_topic_cache;
+    };
   return __get_service_names_and_types_by_node(
     identifier,
     node,
@@ -518,6 +489,7 @@ __rmw_get_service_names_and_types_by_node(
     node_name,
     node_namespace,
     service_names_and_types,
+    retrieve_sub_cache,
     "Request");
 }
 
@@ -530,6 +502,12 @@ __rmw_get_client_names_and_types_by_node(
   const char * node_namespace,
   rmw_names_and_types_t * service_names_and_types)
 {
+  // Clients are found by their request writer: their response reader is shared with the other
+  // clients of the participant, and only listed under the node of the first one.
+  RetrieveCache retrieve_pub_cache =
+    [](CustomParticipantInfo & participant_info) -> const LockedObject<TopicCache> & {
+      return participant_info.graph_cache->writer_topic_cache;
+    };
   return __get_service_names_and_types_by_node(
     identifier,
     node,
@@ -537,7 +515,8 @@ __rmw_get_client_names_and_types_by_node(
     node_name,
     node_namespace,
     service_names_and_types,
-    "Reply");
+    retrieve_pub_cache,
+    "Request");
 }
 
 }  // namespace rmw_fastrtps_shared_cpp
@@ -20,6 +20,7 @@
 #include "rmw/rmw.h"
 
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_allocation_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
@@ -32,7 +33,6 @@ __rmw_publish(
   const void * ros_message,
   rmw_publisher_allocation_t * allocation)
 {
-  (void) allocation;
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(publisher, "publisher pointer is null", return RMW_RET_ERROR);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(
     ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
@@ -45,6 +45,11 @@ __rmw_publish(
   auto info = static_cast<CustomPublisherInfo *>(publisher->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "publisher info pointer is null", return RMW_RET_ERROR);
 
+  // The message is serialized straight into the change payload, with or without an allocation
+  if (allocation && !get_allocation_info(identifier, allocation)) {
+    return RMW_RET_ERROR;  // Error message already set
+  }
+
   rmw_fastrtps_shared_cpp::SerializedData data;
   data.is_cdr_buffer = false;
   data.data = const_cast<void *>(ros_message);
@@ -97,4 +102,40 @@ __rmw_publish_serialized_message(
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_publish_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(publisher, "publisher pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_message, "ros_message pointer is null", return RMW_RET_ERROR);
+
+  if (publisher->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("publisher handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (!publisher->can_loan_messages || info == nullptr || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  if (!info->loan_pool_->is_loaned(ros_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  rmw_ret_t ret = __rmw_publish(identifier, publisher, ros_message, allocation);
+  // The loan ends with the call, whether it succeeded or not
+  if (!info->loan_pool_->give_back(ros_message) && RMW_RET_OK == ret) {
+    RMW_SET_ERROR_MSG("message was given back while it was being published");
+    ret = RMW_RET_ERROR;
+  }
+  return ret;
+}
 }  // namespace rmw_fastrtps_shared_cpp
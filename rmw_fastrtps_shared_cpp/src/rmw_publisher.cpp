@@ -29,6 +29,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 
@@ -62,6 +64,10 @@ __rmw_destroy_publisher(
 
   auto info = static_cast<CustomPublisherInfo *>(publisher->data);
   if (info != nullptr) {
+    // Make sure no wait set keeps a reference to the listener
+    if (info->listener_ != nullptr) {
+      clean_wait_set_caches(info->listener_->getReadyListEntry());
+    }
     if (info->publisher_ != nullptr) {
       Domain::removePublisher(info->publisher_);
     }
@@ -148,4 +154,63 @@ __rmw_publisher_get_actual_qos(
 
   return RMW_RET_OK;
 }
+
+rmw_ret_t
+__rmw_borrow_loaned_message(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void ** ros_message)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_ERROR);
+  if (*ros_message != nullptr) {
+    RMW_SET_ERROR_MSG("ros_message is not null, it would leak");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (!publisher->can_loan_messages || info == nullptr || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  *ros_message = info->loan_pool_->borrow();
+  if (*ros_message == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_return_loaned_message_from_publisher(
+  const char * identifier,
+  const rmw_publisher_t * publisher,
+  void * loaned_message)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    identifier,
+    return RMW_RET_ERROR);
+
+  auto info = static_cast<CustomPublisherInfo *>(publisher->data);
+  if (!publisher->can_loan_messages || info == nullptr || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("publisher cannot loan messages");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  if (!info->loan_pool_->give_back(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this publisher");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return RMW_RET_OK;
+}
 }  // namespace rmw_fastrtps_shared_cpp
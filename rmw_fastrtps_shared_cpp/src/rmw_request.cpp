@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cassert>
+#include <chrono>
 
 #include "fastcdr/Cdr.h"
 #include "fastcdr/FastBuffer.h"
@@ -28,13 +29,14 @@
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
-namespace rmw_fastrtps_shared_cpp
+namespace
 {
 rmw_ret_t
-__rmw_send_request(
+_send_request(
   const char * identifier,
   const rmw_client_t * client,
   const void * ros_request,
+  std::chrono::steady_clock::time_point deadline,
   int64_t * sequence_id)
 {
   assert(client);
@@ -58,14 +60,44 @@ __rmw_send_request(
   data.impl = info->request_type_support_impl_;
   if (info->request_publisher_->write(&data, wparams)) {
     returnedValue = RMW_RET_OK;
-    *sequence_id = ((int64_t)wparams.sample_identity().sequence_number().high) << 32 |
-      wparams.sample_identity().sequence_number().low;
+    *sequence_id = ClientListener::getSequenceNumber(wparams.sample_identity());
+    info->listener_->addRequest(*sequence_id, deadline);
   } else {
     RMW_SET_ERROR_MSG("cannot publish data");
   }
 
   return returnedValue;
 }
+}  // namespace
+
+namespace rmw_fastrtps_shared_cpp
+{
+rmw_ret_t
+__rmw_send_request(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * ros_request,
+  int64_t * sequence_id)
+{
+  return _send_request(
+    identifier, client, ros_request, std::chrono::steady_clock::time_point::max(), sequence_id);
+}
+
+rmw_ret_t
+__rmw_send_request_with_timeout(
+  const char * identifier,
+  const rmw_client_t * client,
+  const void * ros_request,
+  rmw_time_t timeout,
+  int64_t * sequence_id)
+{
+  auto deadline = std::chrono::steady_clock::time_point::max();
+  if (timeout.sec != 0 || timeout.nsec != 0) {
+    deadline = std::chrono::steady_clock::now() +
+      std::chrono::seconds(timeout.sec) + std::chrono::nanoseconds(timeout.nsec);
+  }
+  return _send_request(identifier, client, ros_request, deadline, sequence_id);
+}
 
 rmw_ret_t
 __rmw_take_request(
@@ -90,23 +122,24 @@ __rmw_take_request(
   auto info = static_cast<CustomServiceInfo *>(service->data);
   assert(info);
 
-  CustomServiceRequest request = info->listener_->getRequest();
-
-  if (request.buffer_ != nullptr) {
-    eprosima::fastcdr::Cdr deser(*request.buffer_, eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-      eprosima::fastcdr::Cdr::DDS_CDR);
-    info->request_type_support_->deserializeROSmessage(
-      deser, ros_request, info->request_type_support_impl_);
-
-    // Get header
-    memcpy(request_header->writer_guid, &request.sample_identity_.writer_guid(),
-      sizeof(eprosima::fastrtps::rtps::GUID_t));
-    request_header->sequence_number = ((int64_t)request.sample_identity_.sequence_number().high) <<
-      32 | request.sample_identity_.sequence_number().low;
-
-    delete request.buffer_;
+  eprosima::fastrtps::SampleInfo_t sinfo;
 
-    *taken = true;
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.is_cdr_buffer = false;
+  data.data = ros_request;
+  data.impl = info->request_type_support_impl_;
+  if (info->request_subscriber_->takeNextData(&data, &sinfo)) {
+    info->listener_->data_taken(info->request_subscriber_);
+
+    if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+      // Get header
+      memcpy(request_header->writer_guid, &sinfo.sample_identity.writer_guid(),
+        sizeof(eprosima::fastrtps::rtps::GUID_t));
+      request_header->sequence_number = ((int64_t)sinfo.sample_identity.sequence_number().high) <<
+        32 | sinfo.sample_identity.sequence_number().low;
+
+      *taken = true;
+    }
   }
 
   return RMW_RET_OK;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cassert>
+#include <utility>
 
 #include "fastcdr/Cdr.h"
 
@@ -24,8 +25,32 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/response_reader.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+namespace
+{
+void
+_deserialize_response(
+  CustomClientInfo * info,
+  CustomClientResponse & response,
+  rmw_request_id_t * request_header,
+  void * ros_response)
+{
+  eprosima::fastcdr::Cdr deser(
+    *response.buffer_,
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr::DDS_CDR);
+  info->response_type_support_->deserializeROSmessage(
+    deser, ros_response, info->response_type_support_impl_);
+
+  request_header->sequence_number =
+    ClientListener::getSequenceNumber(response.sample_identity_);
+
+  info->response_reader_->returnBuffer(std::move(response.buffer_));
+}
+}  // namespace
+
 namespace rmw_fastrtps_shared_cpp
 {
 rmw_ret_t
@@ -54,22 +79,56 @@ __rmw_take_response(
   CustomClientResponse response;
 
   if (info->listener_->getResponse(response)) {
-    eprosima::fastcdr::Cdr deser(
-      *response.buffer_,
-      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-      eprosima::fastcdr::Cdr::DDS_CDR);
-    info->response_type_support_->deserializeROSmessage(
-      deser, ros_response, info->response_type_support_impl_);
-
-    request_header->sequence_number = ((int64_t)response.sample_identity_.sequence_number().high) <<
-      32 | response.sample_identity_.sequence_number().low;
-
+    _deserialize_response(info, response, request_header, ros_response);
     *taken = true;
   }
 
   return RMW_RET_OK;
 }
 
+rmw_ret_t
+__rmw_take_response_for_request(
+  const char * identifier,
+  const rmw_client_t * client,
+  int64_t sequence_id,
+  rmw_request_id_t * request_header,
+  void * ros_response,
+  bool * taken)
+{
+  assert(client);
+  assert(request_header);
+  assert(ros_response);
+  assert(taken);
+
+  *taken = false;
+
+  if (client->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("client handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomClientInfo *>(client->data);
+  assert(info);
+
+  CustomClientResponse response;
+
+  switch (info->listener_->getResponse(sequence_id, response)) {
+    case ClientListener::RequestState::completed:
+      _deserialize_response(info, response, request_header, ros_response);
+      *taken = true;
+      return RMW_RET_OK;
+    case ClientListener::RequestState::pending:
+      return RMW_RET_OK;
+    case ClientListener::RequestState::timed_out:
+      RMW_SET_ERROR_MSG("request timed out before its response arrived");
+      return RMW_RET_TIMEOUT;
+    case ClientListener::RequestState::unknown:
+    default:
+      RMW_SET_ERROR_MSG("request is not in flight");
+      return RMW_RET_INVALID_ARGUMENT;
+  }
+}
+
 rmw_ret_t
 __rmw_send_response(
   const char * identifier,
@@ -37,6 +37,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -61,6 +63,10 @@ __rmw_destroy_service(
 
   CustomServiceInfo * info = static_cast<CustomServiceInfo *>(service->data);
   if (info != nullptr) {
+    // Make sure no wait set keeps a reference to the listener
+    if (info->listener_ != nullptr) {
+      clean_wait_set_caches(info->listener_->getReadyListEntry());
+    }
     if (info->request_subscriber_ != nullptr) {
       Domain::removeSubscriber(info->request_subscriber_);
     }
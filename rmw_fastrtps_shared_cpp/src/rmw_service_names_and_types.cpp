@@ -14,6 +14,7 @@
 
 #include <map>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -26,7 +27,6 @@
 #include "rmw/names_and_types.h"
 #include "rmw/rmw.h"
 
-#include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
 
@@ -69,15 +69,16 @@ __rmw_get_service_names_and_types(
 
   // Setup processing function, will be used with two maps
   auto map_process = [&services](const LockedObject<TopicCache> & topic_cache) {
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-      for (auto it : topic_cache().getTopicToTypes()) {
-        std::string service_name = _demangle_service_from_topic(it.first);
+      std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
+      for (const auto & it : topic_cache().getTopicToTypes()) {
+        const std::string & service_name = topic_cache().getDemangledTopic(it.first).service_name;
         if (service_name.empty()) {
           // not a service
           continue;
         }
-        for (auto & itt : it.second) {
-          std::string service_type = _demangle_service_type_only(itt);
+        for (const auto & itt : it.second) {
+          const std::string & service_type =
+            topic_cache().getDemangledType(itt).service_type_name;
           if (!service_type.empty()) {
             services[service_name].insert(service_type);
           }
@@ -85,7 +86,7 @@ __rmw_get_service_names_and_types(
       }
     };
 
-  ::ParticipantListener * slave_target = impl->listener;
+  GraphCache * slave_target = impl->graph_cache.get();
   map_process(slave_target->reader_topic_cache);
   map_process(slave_target->writer_topic_cache);
 
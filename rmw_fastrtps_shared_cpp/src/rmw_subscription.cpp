@@ -31,6 +31,8 @@
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
+#include "types/custom_wait_set_info.hpp"
+
 using Domain = eprosima::fastrtps::Domain;
 using Participant = eprosima::fastrtps::Participant;
 using TopicDataType = eprosima::fastrtps::TopicDataType;
@@ -66,6 +68,10 @@ __rmw_destroy_subscription(
   auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
 
   if (info != nullptr) {
+    // Make sure no wait set keeps a reference to the listener
+    if (info->listener_ != nullptr) {
+      clean_wait_set_caches(info->listener_->getReadyListEntry());
+    }
     if (info->subscriber_ != nullptr) {
       Domain::removeSubscriber(info->subscriber_);
     }
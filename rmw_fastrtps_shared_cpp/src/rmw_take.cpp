@@ -25,6 +25,7 @@
 #include "fastcdr/FastBuffer.h"
 
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_allocation_info.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
 #include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
 
@@ -52,7 +53,6 @@ _take(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation)
 {
-  (void) allocation;
   *taken = false;
 
   if (subscription->implementation_identifier != identifier) {
@@ -63,18 +63,27 @@ _take(
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
 
-  eprosima::fastrtps::SampleInfo_t sinfo;
+  eprosima::fastrtps::SampleInfo_t local_sinfo;
+  eprosima::fastrtps::SampleInfo_t * sinfo = &local_sinfo;
+  if (allocation) {
+    auto allocation_info = get_allocation_info(identifier, allocation);
+    if (!allocation_info) {
+      return RMW_RET_ERROR;  // Error message already set
+    }
+    sinfo = &allocation_info->sample_info_;
+  }
 
+  // Messages are deserialized straight from the change payload
   rmw_fastrtps_shared_cpp::SerializedData data;
   data.is_cdr_buffer = false;
   data.data = ros_message;
   data.impl = info->type_support_impl_;
-  if (info->subscriber_->takeNextData(&data, &sinfo)) {
+  if (info->subscriber_->takeNextData(&data, sinfo)) {
     info->listener_->data_taken(info->subscriber_);
 
-    if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
+    if (eprosima::fastrtps::rtps::ALIVE == sinfo->sampleKind) {
       if (message_info) {
-        _assign_message_info(identifier, message_info, &sinfo);
+        _assign_message_info(identifier, message_info, sinfo);
       }
       *taken = true;
     }
@@ -148,6 +157,171 @@ __rmw_take_with_info(
   return _take(identifier, subscription, ros_message, taken, message_info, allocation);
 }
 
+rmw_ret_t
+_take_loaned_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    loaned_message, "loaned message pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "boolean flag for taken is null", return RMW_RET_ERROR);
+  if (*loaned_message != nullptr) {
+    RMW_SET_ERROR_MSG("loaned message is not null, it would leak");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  *taken = false;
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  if (!subscription->can_loan_messages || info == nullptr || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("subscription cannot loan messages");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  void * message = info->loan_pool_->borrow();
+  if (message == nullptr) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
+  rmw_ret_t ret = _take(identifier, subscription, message, taken, message_info, allocation);
+  if (RMW_RET_OK == ret && *taken) {
+    *loaned_message = message;
+  } else {
+    info->loan_pool_->give_back(message);
+  }
+  return ret;
+}
+
+rmw_ret_t
+__rmw_take_loaned_message(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  return _take_loaned_message(
+    identifier, subscription, loaned_message, taken, nullptr, allocation);
+}
+
+rmw_ret_t
+__rmw_take_loaned_message_with_info(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    message_info, "message info pointer is null", return RMW_RET_ERROR);
+
+  return _take_loaned_message(
+    identifier, subscription, loaned_message, taken, message_info, allocation);
+}
+
+rmw_ret_t
+__rmw_return_loaned_message_from_subscription(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  void * loaned_message)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    loaned_message, "loaned message pointer is null", return RMW_RET_ERROR);
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  auto info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  if (!subscription->can_loan_messages || info == nullptr || !info->loan_pool_) {
+    RMW_SET_ERROR_MSG("subscription cannot loan messages");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  if (!info->loan_pool_->give_back(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned by this subscription");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return RMW_RET_OK;
+}
+
+rmw_ret_t
+__rmw_take_sequence(
+  const char * identifier,
+  const rmw_subscription_t * subscription,
+  size_t count,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    subscription, "subscription pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(
+    ros_messages, "ros_messages pointer is null", return RMW_RET_ERROR);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(taken, "size_t for taken is null", return RMW_RET_ERROR);
+
+  *taken = 0;
+
+  if (subscription->implementation_identifier != identifier) {
+    RMW_SET_ERROR_MSG("subscription handle not from this implementation");
+    return RMW_RET_ERROR;
+  }
+
+  CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
+  RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
+
+  eprosima::fastrtps::SampleInfo_t local_sinfo;
+  eprosima::fastrtps::SampleInfo_t * sinfo = &local_sinfo;
+  if (allocation) {
+    auto allocation_info = get_allocation_info(identifier, allocation);
+    if (!allocation_info) {
+      return RMW_RET_ERROR;  // Error message already set
+    }
+    sinfo = &allocation_info->sample_info_;
+  }
+
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.is_cdr_buffer = false;
+  data.impl = info->type_support_impl_;
+  bool taken_from_history = false;
+  while (*taken < count) {
+    data.data = ros_messages[*taken];
+    if (!info->subscriber_->takeNextData(&data, sinfo)) {
+      break;
+    }
+    taken_from_history = true;
+
+    if (eprosima::fastrtps::rtps::ALIVE == sinfo->sampleKind) {
+      if (message_infos) {
+        _assign_message_info(identifier, &message_infos[*taken], sinfo);
+      }
+      ++(*taken);
+    }
+  }
+
+  // Update the unread count once for the whole batch
+  if (taken_from_history) {
+    info->listener_->data_taken(info->subscriber_);
+  }
+
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
 _take_serialized_message(
   const char * identifier,
@@ -157,7 +331,6 @@ _take_serialized_message(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation)
 {
-  (void) allocation;
   *taken = false;
 
   if (subscription->implementation_identifier != identifier) {
@@ -168,29 +341,41 @@ _take_serialized_message(
   CustomSubscriberInfo * info = static_cast<CustomSubscriberInfo *>(subscription->data);
   RCUTILS_CHECK_FOR_NULL_WITH_MSG(info, "custom subscriber info is null", return RMW_RET_ERROR);
 
-  eprosima::fastcdr::FastBuffer buffer;
-  eprosima::fastrtps::SampleInfo_t sinfo;
+  // With an allocation, take into its buffer and sample info, which fit any message of the type
+  eprosima::fastcdr::FastBuffer local_buffer;
+  eprosima::fastcdr::FastBuffer * buffer = &local_buffer;
+  eprosima::fastrtps::SampleInfo_t local_sinfo;
+  eprosima::fastrtps::SampleInfo_t * sinfo = &local_sinfo;
+  if (allocation) {
+    auto allocation_info = get_allocation_info(identifier, allocation);
+    if (!allocation_info) {
+      return RMW_RET_ERROR;  // Error message already set
+    }
+    buffer = &allocation_info->buffer_;
+    sinfo = &allocation_info->sample_info_;
+  }
 
   rmw_fastrtps_shared_cpp::SerializedData data;
   data.is_cdr_buffer = true;
-  data.data = &buffer;
+  data.data = buffer;
   data.impl = nullptr;    // not used when is_cdr_buffer is true
-  if (info->subscriber_->takeNextData(&data, &sinfo)) {
+  if (info->subscriber_->takeNextData(&data, sinfo)) {
     info->listener_->data_taken(info->subscriber_);
 
-    if (eprosima::fastrtps::rtps::ALIVE == sinfo.sampleKind) {
-      auto buffer_size = static_cast<size_t>(buffer.getBufferSize());
+    if (eprosima::fastrtps::rtps::ALIVE == sinfo->sampleKind) {
+      auto buffer_size = data.length;
+      // Only grows serialized messages which were not sized for the type already
       if (serialized_message->buffer_capacity < buffer_size) {
         auto ret = rmw_serialized_message_resize(serialized_message, buffer_size);
         if (ret != RMW_RET_OK) {
           return ret;  // Error message already set
         }
       }
+      memcpy(serialized_message->buffer, buffer->getBuffer(), buffer_size);
       serialized_message->buffer_length = buffer_size;
-      memcpy(serialized_message->buffer, buffer.getBuffer(), serialized_message->buffer_length);
 
       if (message_info) {
-        _assign_message_info(identifier, message_info, &sinfo);
+        _assign_message_info(identifier, message_info, sinfo);
       }
       *taken = true;
     }
@@ -14,6 +14,7 @@
 
 #include <map>
 #include <set>
+#include <shared_mutex>
 #include <string>
 
 #include <functional>
@@ -33,9 +34,7 @@
 #include "rmw/names_and_types.h"
 #include "rmw/rmw.h"
 
-#include "demangle.hpp"
 #include "rmw_fastrtps_shared_cpp/custom_participant_info.hpp"
-#include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "rmw_fastrtps_shared_cpp/topic_cache.hpp"
@@ -80,19 +79,25 @@ __rmw_get_topic_names_and_types(
   // Setup processing function, will be used with two maps
   auto map_process =
     [&topics, no_demangle](const LockedObject<TopicCache> & topic_cache) {
-      std::lock_guard<std::mutex> guard(topic_cache.getMutex());
-      for (auto it : topic_cache().getTopicToTypes()) {
-        if (!no_demangle && _get_ros_prefix_if_exists(it.first) != ros_topic_prefix) {
+      std::shared_lock<SharedMutex> guard(topic_cache.getMutex());
+      for (const auto & it : topic_cache().getTopicToTypes()) {
+        if (no_demangle) {
+          topics[it.first].insert(it.second.begin(), it.second.end());
+          continue;
+        }
+        const DemangledTopic & demangled_topic = topic_cache().getDemangledTopic(it.first);
+        if (!demangled_topic.is_ros_topic) {
           // if we are demangling and this is not prefixed with rt/, skip it
           continue;
         }
-        for (auto & itt : it.second) {
-          topics[it.first].insert(itt);
+        auto & types = topics[demangled_topic.topic_name];
+        for (const auto & itt : it.second) {
+          types.insert(topic_cache().getDemangledType(itt).type_name);
         }
       }
     };
 
-  ::ParticipantListener * slave_target = impl->listener;
+  GraphCache * slave_target = impl->graph_cache.get();
   map_process(slave_target->reader_topic_cache);
   map_process(slave_target->writer_topic_cache);
 
@@ -112,21 +117,11 @@ __rmw_get_topic_names_and_types(
             "error during report of error: %s", rmw_get_error_string().str);
         }
       };
-    // Setup demangling functions based on no_demangle option
-    auto demangle_topic = _demangle_if_ros_topic;
-    auto demangle_type = _demangle_if_ros_type;
-    if (no_demangle) {
-      auto noop = [](const std::string & in) {
-          return in;
-        };
-      demangle_topic = noop;
-      demangle_type = noop;
-    }
     // For each topic, store the name, initialize the string array for types, and store all types
     size_t index = 0;
     for (const auto & topic_n_types : topics) {
       // Duplicate and store the topic_name
-      char * topic_name = rcutils_strdup(demangle_topic(topic_n_types.first).c_str(), *allocator);
+      char * topic_name = rcutils_strdup(topic_n_types.first.c_str(), *allocator);
       if (!topic_name) {
         RMW_SET_ERROR_MSG("failed to allocate memory for topic name");
         fail_cleanup();
@@ -148,7 +143,7 @@ __rmw_get_topic_names_and_types(
       // Duplicate and store each type for the topic
       size_t type_index = 0;
       for (const auto & type : topic_n_types.second) {
-        char * type_name = rcutils_strdup(demangle_type(type).c_str(), *allocator);
+        char * type_name = rcutils_strdup(type.c_str(), *allocator);
         if (!type_name) {
           RMW_SET_ERROR_MSG("failed to allocate memory for type name");
           fail_cleanup();
@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
 #include "fastrtps/subscriber/Subscriber.h"
 
 #include "rmw/error_handling.h"
@@ -24,66 +28,188 @@
 #include "types/custom_wait_set_info.hpp"
 #include "types/guard_condition.hpp"
 
-// helper function for wait
+// helper functions for wait
+template<typename GetEntityT>
 bool
-check_wait_set_for_data(
+same_entities(const std::vector<void *> & attached, size_t count, GetEntityT get_entity)
+{
+  if (attached.size() != count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (attached[i] != get_entity(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename GetEntityT, typename DetachT>
+void
+detach_removed_entities(
+  const std::vector<void *> & attached, size_t count, GetEntityT get_entity, DetachT detach)
+{
+  if (same_entities(attached, count, get_entity)) {
+    return;
+  }
+  std::unordered_set<void *> current;
+  current.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    current.insert(get_entity(i));
+  }
+  for (void * data : attached) {
+    if (current.find(data) == current.end()) {
+      detach(data);
+    }
+  }
+}
+
+template<typename GetEntityT, typename AttachT>
+void
+attach_entities(
+  std::vector<void *> & attached, size_t count, GetEntityT get_entity, AttachT attach)
+{
+  attached.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    attached[i] = get_entity(i);
+    attach(attached[i]);
+  }
+}
+
+void * &
+slot_handle(
+  const CustomWaitsetSlot & slot,
   const rmw_subscriptions_t * subscriptions,
   const rmw_guard_conditions_t * guard_conditions,
   const rmw_services_t * services,
   const rmw_clients_t * clients,
   const rmw_events_t * events)
 {
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      // Short circuiting out of this function is possible
-      if (custom_subscriber_info && custom_subscriber_info->listener_->hasData()) {
-        return true;
-      }
-    }
+  switch (slot.kind) {
+    case CustomWaitsetSlot::SUBSCRIPTION:
+      return subscriptions->subscribers[slot.index];
+    case CustomWaitsetSlot::CLIENT:
+      return clients->clients[slot.index];
+    case CustomWaitsetSlot::SERVICE:
+      return services->services[slot.index];
+    case CustomWaitsetSlot::EVENT:
+      return events->events[slot.index];
+    case CustomWaitsetSlot::GUARD_CONDITION:
+    default:
+      return guard_conditions->guard_conditions[slot.index];
   }
+}
 
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      if (custom_client_info && custom_client_info->listener_->hasData()) {
-        return true;
+bool
+is_slot_ready(
+  const CustomWaitsetSlot & slot,
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  const rmw_events_t * events)
+{
+  void * data = slot_handle(slot, subscriptions, guard_conditions, services, clients, events);
+  switch (slot.kind) {
+    case CustomWaitsetSlot::SUBSCRIPTION:
+      return static_cast<CustomSubscriberInfo *>(data)->listener_->hasData();
+    case CustomWaitsetSlot::CLIENT:
+      return static_cast<CustomClientInfo *>(data)->listener_->hasData();
+    case CustomWaitsetSlot::SERVICE:
+      return static_cast<CustomServiceInfo *>(data)->listener_->hasData();
+    case CustomWaitsetSlot::EVENT:
+      {
+        auto event = static_cast<rmw_event_t *>(data);
+        auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
+        return custom_event_info->getListener()->hasEvent(event->event_type);
       }
-    }
+    case CustomWaitsetSlot::GUARD_CONDITION:
+      return static_cast<GuardCondition *>(data)->hasTriggered();
   }
+  return false;
+}
 
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      CustomServiceInfo * custom_service_info = static_cast<CustomServiceInfo *>(data);
-      if (custom_service_info && custom_service_info->listener_->hasData()) {
-        return true;
+// Append the entries of the ready list, the ones still pending since the last call and the
+// adopted ones, which have at least one ready slot to wait_set_info->ready. The other entries
+// are released.
+void
+collect_ready_entries(
+  CustomWaitsetInfo * wait_set_info,
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  const rmw_events_t * events)
+{
+  using rmw_fastrtps_shared_cpp::ReadyList;
+  using rmw_fastrtps_shared_cpp::ReadyListEntry;
+
+  auto is_entry_ready = [&](const std::vector<CustomWaitsetSlot> & slots) {
+      for (const CustomWaitsetSlot & slot : slots) {
+        if (is_slot_ready(slot, subscriptions, guard_conditions, services, clients, events)) {
+          return true;
+        }
+      }
+      return false;
+    };
+  ReadyList * ready_list = &wait_set_info->ready_list;
+  // The entry must be held by ready_list
+  auto check_entry = [&](ReadyListEntry * entry) {
+      auto it = wait_set_info->slots.find(entry);
+      if (it == wait_set_info->slots.end() || entry->owner() != ready_list) {
+        // Released for the wait set which attached the entity since, if any
+        ready_list->release(entry);
+        return;
+      }
+      if (is_entry_ready(it->second)) {
+        wait_set_info->ready.push_back(entry);
+        return;
+      }
+      ready_list->release(entry);
+      // The entity may have become ready between the check and the release, without being able
+      // to queue itself again
+      if (is_entry_ready(it->second)) {
+        ready_list->push(entry);
       }
+    };
+
+  for (ReadyListEntry * entry : wait_set_info->pending) {
+    // Ready adopted entries are not held, they are checked below again
+    if (entry->queued_in() == ready_list) {
+      check_entry(entry);
     }
   }
+  wait_set_info->pending.clear();
 
-  if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
-      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      if (custom_event_info->getListener()->hasEvent(event->event_type)) {
-        return true;
-      }
+  size_t adopted_count = 0;
+  for (ReadyListEntry * entry : wait_set_info->adopted) {
+    auto it = wait_set_info->slots.find(entry);
+    if (it == wait_set_info->slots.end() || entry->owner() != ready_list) {
+      continue;
+    }
+    if (ready_list->claim(entry)) {
+      // Released by the other wait set
+      check_entry(entry);
+      continue;
+    }
+    if (entry->queued_in() == ready_list) {
+      // Claimed through a push, it is taken below
+      continue;
+    }
+    wait_set_info->adopted[adopted_count++] = entry;
+    if (is_entry_ready(it->second)) {
+      wait_set_info->ready.push_back(entry);
     }
   }
+  wait_set_info->adopted.resize(adopted_count);
 
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      if (guard_condition && guard_condition->hasTriggered()) {
-        return true;
-      }
-    }
+  ReadyListEntry * entry = ready_list->take_all();
+  while (entry != nullptr) {
+    // Read the next entry first, as a released entry can be pushed again at any time
+    ReadyListEntry * next = entry->next();
+    check_entry(entry);
+    entry = next;
   }
-  return false;
 }
 
 namespace rmw_fastrtps_shared_cpp
@@ -117,133 +243,277 @@ __rmw_wait(
     RMW_SET_ERROR_MSG("Condition variable for wait set was null");
     return RMW_RET_ERROR;
   }
+  // Listeners only lock the mutex and notify the condition variable when we wait on them
+  std::mutex * attachMutex = wait_set_info->use_park ? nullptr : conditionMutex;
+  std::condition_variable * attachVariable =
+    wait_set_info->use_park ? nullptr : conditionVariable;
 
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
+  auto get_subscription = [subscriptions](size_t i) {
+      return subscriptions->subscribers[i];
+    };
+  auto get_client = [clients](size_t i) {
+      return clients->clients[i];
+    };
+  auto get_service = [services](size_t i) {
+      return services->services[i];
+    };
+  auto get_event = [events](size_t i) {
+      return static_cast<rmw_event_t *>(events->events[i])->data;
+    };
+  auto get_event_handle = [events](size_t i) {
+      return events->events[i];
+    };
+  auto get_guard_condition = [guard_conditions](size_t i) {
+      return guard_conditions->guard_conditions[i];
+    };
+  size_t subscription_count = subscriptions ? subscriptions->subscriber_count : 0;
+  size_t client_count = clients ? clients->client_count : 0;
+  size_t service_count = services ? services->service_count : 0;
+  size_t event_count = events ? events->event_count : 0;
+  size_t guard_condition_count = guard_conditions ? guard_conditions->guard_condition_count : 0;
 
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
+  {
+    std::lock_guard<std::mutex> cache_lock(wait_set_info->cache_mutex);
+    wait_set_info->in_use = true;
 
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->attachCondition(conditionMutex, conditionVariable);
-    }
-  }
+    // Entities attached by a previous call stay attached, so nothing needs to be done as long as
+    // the same entities are passed in. Everything is attached again when they differ (a
+    // subscription and its events share a listener, so detaching one detaches the other), or
+    // when another wait set attached one of them since our last call.
+    ReadyList * ready_list = &wait_set_info->ready_list;
+    bool changed =
+      !same_entities(wait_set_info->subscriptions, subscription_count, get_subscription) ||
+      !same_entities(wait_set_info->clients, client_count, get_client) ||
+      !same_entities(wait_set_info->services, service_count, get_service) ||
+      !same_entities(wait_set_info->events, event_count, get_event) ||
+      !same_entities(wait_set_info->event_handles, event_count, get_event_handle) ||
+      !same_entities(wait_set_info->guard_conditions, guard_condition_count, get_guard_condition);
 
-  if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
-      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      custom_event_info->getListener()->attachCondition(conditionMutex, conditionVariable);
+    if (!changed) {
+      for (const auto & entry_slots : wait_set_info->slots) {
+        if (entry_slots.first->owner() != ready_list) {
+          changed = true;
+          break;
+        }
+      }
     }
-  }
 
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->attachCondition(conditionMutex, conditionVariable);
+    if (changed) {
+      // Entities which another wait set attached since are left alone
+      detach_removed_entities(
+        wait_set_info->subscriptions, subscription_count, get_subscription,
+        [ready_list](void * data) {
+          auto listener = static_cast<CustomSubscriberInfo *>(data)->listener_;
+          detach_if_owned(
+            listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+        });
+      detach_removed_entities(
+        wait_set_info->clients, client_count, get_client,
+        [ready_list](void * data) {
+          auto listener = static_cast<CustomClientInfo *>(data)->listener_;
+          detach_if_owned(
+            listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+        });
+      detach_removed_entities(
+        wait_set_info->services, service_count, get_service,
+        [ready_list](void * data) {
+          auto listener = static_cast<CustomServiceInfo *>(data)->listener_;
+          detach_if_owned(
+            listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+        });
+      detach_removed_entities(
+        wait_set_info->events, event_count, get_event,
+        [ready_list](void * data) {
+          auto listener = static_cast<CustomEventInfo *>(data)->getListener();
+          detach_if_owned(
+            listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+        });
+      detach_removed_entities(
+        wait_set_info->guard_conditions, guard_condition_count, get_guard_condition,
+        [ready_list](void * data) {
+          auto guard_condition = static_cast<GuardCondition *>(data);
+          detach_if_owned(
+            guard_condition->getReadyListEntry(), ready_list,
+            [guard_condition]() {guard_condition->detachCondition();});
+        });
+
+      // Entities which are queued on our ready list or were pending might not be part of this
+      // call anymore, start from scratch
+      reset_ready_entries(wait_set_info);
+
+      attach_entities(
+        wait_set_info->subscriptions, subscription_count, get_subscription,
+        [attachMutex, attachVariable, ready_list](void * data) {
+          auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
+          custom_subscriber_info->listener_->attachCondition(
+            attachMutex, attachVariable, ready_list);
+        });
+      attach_entities(
+        wait_set_info->clients, client_count, get_client,
+        [attachMutex, attachVariable, ready_list](void * data) {
+          CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
+          custom_client_info->listener_->attachCondition(
+            attachMutex, attachVariable, ready_list);
+        });
+      attach_entities(
+        wait_set_info->services, service_count, get_service,
+        [attachMutex, attachVariable, ready_list](void * data) {
+          auto custom_service_info = static_cast<CustomServiceInfo *>(data);
+          custom_service_info->listener_->attachCondition(
+            attachMutex, attachVariable, ready_list);
+        });
+      attach_entities(
+        wait_set_info->events, event_count, get_event,
+        [attachMutex, attachVariable, ready_list](void * data) {
+          auto custom_event_info = static_cast<CustomEventInfo *>(data);
+          custom_event_info->getListener()->attachCondition(
+            attachMutex, attachVariable, ready_list);
+        });
+      wait_set_info->event_handles.resize(event_count);
+      for (size_t i = 0; i < event_count; ++i) {
+        wait_set_info->event_handles[i] = get_event_handle(i);
+      }
+      attach_entities(
+        wait_set_info->guard_conditions, guard_condition_count, get_guard_condition,
+        [attachMutex, attachVariable, ready_list](void * data) {
+          auto guard_condition = static_cast<GuardCondition *>(data);
+          guard_condition->attachCondition(attachMutex, attachVariable, ready_list);
+        });
+
+      auto add_slot = [wait_set_info](
+        ReadyListEntry * entry, CustomWaitsetSlot::Kind kind, size_t index) {
+          wait_set_info->slots[entry].push_back({kind, index});
+        };
+      for (size_t i = 0; i < subscription_count; ++i) {
+        auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(get_subscription(i));
+        add_slot(
+          custom_subscriber_info->listener_->getReadyListEntry(),
+          CustomWaitsetSlot::SUBSCRIPTION, i);
+      }
+      for (size_t i = 0; i < client_count; ++i) {
+        auto custom_client_info = static_cast<CustomClientInfo *>(get_client(i));
+        add_slot(
+          custom_client_info->listener_->getReadyListEntry(), CustomWaitsetSlot::CLIENT, i);
+      }
+      for (size_t i = 0; i < service_count; ++i) {
+        auto custom_service_info = static_cast<CustomServiceInfo *>(get_service(i));
+        add_slot(
+          custom_service_info->listener_->getReadyListEntry(), CustomWaitsetSlot::SERVICE, i);
+      }
+      for (size_t i = 0; i < event_count; ++i) {
+        auto custom_event_info = static_cast<CustomEventInfo *>(get_event(i));
+        add_slot(
+          custom_event_info->getListener()->getReadyListEntry(), CustomWaitsetSlot::EVENT, i);
+      }
+      for (size_t i = 0; i < guard_condition_count; ++i) {
+        auto guard_condition = static_cast<GuardCondition *>(get_guard_condition(i));
+        add_slot(guard_condition->getReadyListEntry(), CustomWaitsetSlot::GUARD_CONDITION, i);
+      }
+      // Entities do not queue themselves when they were ready before being attached, so check
+      // all of them once. Those still held by the wait set they were attached to before cannot
+      // queue themselves here until it releases them, so they are checked on every call.
+      for (auto & entry_slots : wait_set_info->slots) {
+        ReadyListEntry * entry = entry_slots.first;
+        entry->set_owner(ready_list);
+        if (ready_list->claim(entry)) {
+          wait_set_info->pending.push_back(entry);
+        } else if (entry->queued_in() != ready_list) {
+          wait_set_info->adopted.push_back(entry);
+        }
+      }
     }
   }
 
-  // This mutex prevents any of the listeners
-  // to change the internal state and notify the condition
-  // between the call to hasData() / hasTriggered() and wait()
-  // otherwise the decision to wait might be incorrect
-  std::unique_lock<std::mutex> lock(*conditionMutex);
-
-  bool hasData = check_wait_set_for_data(
-    subscriptions, guard_conditions, services, clients, events);
-  auto predicate = [subscriptions, guard_conditions, services, clients, events]() {
-      return check_wait_set_for_data(subscriptions, guard_conditions, services, clients, events);
-    };
+  wait_set_info->ready.clear();
+  collect_ready_entries(
+    wait_set_info, subscriptions, guard_conditions, services, clients, events);
 
   bool timeout = false;
-  if (!hasData) {
-    if (!wait_timeout) {
-      conditionVariable->wait(lock, predicate);
-    } else if (wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
+  if (wait_set_info->ready.empty()) {
+    std::chrono::steady_clock::time_point deadline;
+    if (wait_timeout) {
       auto n = std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::seconds(wait_timeout->sec));
       n += std::chrono::nanoseconds(wait_timeout->nsec);
-      timeout = !conditionVariable->wait_for(lock, n, predicate);
-    } else {
-      timeout = true;
+      deadline = std::chrono::steady_clock::now() + n;
+      timeout = n.count() <= 0;
     }
-  }
-
-  // Unlock the condition variable mutex to prevent deadlocks that can occur if
-  // a listener triggers while the condition variable is being detached.
-  // Listeners will no longer be prevented from changing their internal state,
-  // but that should not cause issues (if a listener has data / has triggered
-  // after we check, it will be caught on the next call to this function).
-  lock.unlock();
-
-  if (subscriptions) {
-    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
-      void * data = subscriptions->subscribers[i];
-      auto custom_subscriber_info = static_cast<CustomSubscriberInfo *>(data);
-      custom_subscriber_info->listener_->detachCondition();
-      if (!custom_subscriber_info->listener_->hasData()) {
-        subscriptions->subscribers[i] = 0;
+    // Listeners push on the ready list with the mutex held, so the decision to wait cannot miss
+    // an entity becoming ready. When parking, the ready list itself takes care of that.
+    auto predicate = [wait_set_info]() {
+        return !wait_set_info->ready_list.empty();
+      };
+    while (!timeout && wait_set_info->ready.empty()) {
+      if (wait_set_info->use_park) {
+        if (!wait_timeout) {
+          wait_set_info->ready_list.park(nullptr);
+        } else {
+          auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now());
+          wait_set_info->ready_list.park(&remaining);
+          timeout = std::chrono::steady_clock::now() >= deadline;
+        }
+      } else {
+        std::unique_lock<std::mutex> lock(*conditionMutex);
+        if (!wait_timeout) {
+          conditionVariable->wait(lock, predicate);
+        } else {
+          timeout = !conditionVariable->wait_until(lock, deadline, predicate);
+        }
       }
+      // An entity may have queued itself for an event type that is not waited on, or its data
+      // may already be gone; keep waiting in that case
+      collect_ready_entries(
+        wait_set_info, subscriptions, guard_conditions, services, clients, events);
     }
+    timeout = wait_set_info->ready.empty();
   }
 
-  if (clients) {
-    for (size_t i = 0; i < clients->client_count; ++i) {
-      void * data = clients->clients[i];
-      CustomClientInfo * custom_client_info = static_cast<CustomClientInfo *>(data);
-      custom_client_info->listener_->detachCondition();
-      if (!custom_client_info->listener_->hasData()) {
-        clients->clients[i] = 0;
+  // Find out which slots are ready before clearing the rmw arrays. Listeners may change their
+  // internal state from here on, but that does not cause issues: if a listener has data / has
+  // triggered after we check, it will be caught on the next call to this function.
+  wait_set_info->ready_slots.clear();
+  for (ReadyListEntry * entry : wait_set_info->ready) {
+    for (const CustomWaitsetSlot & slot : wait_set_info->slots.find(entry)->second) {
+      void * data = slot_handle(slot, subscriptions, guard_conditions, services, clients, events);
+      bool is_ready;
+      if (CustomWaitsetSlot::GUARD_CONDITION == slot.kind) {
+        is_ready = static_cast<GuardCondition *>(data)->getHasTriggered();
+      } else {
+        is_ready = is_slot_ready(slot, subscriptions, guard_conditions, services, clients, events);
       }
-    }
-  }
-
-  if (services) {
-    for (size_t i = 0; i < services->service_count; ++i) {
-      void * data = services->services[i];
-      auto custom_service_info = static_cast<CustomServiceInfo *>(data);
-      custom_service_info->listener_->detachCondition();
-      if (!custom_service_info->listener_->hasData()) {
-        services->services[i] = 0;
+      if (is_ready) {
+        wait_set_info->ready_slots.emplace_back(slot, data);
       }
     }
   }
 
-  if (events) {
-    for (size_t i = 0; i < events->event_count; ++i) {
-      auto event = static_cast<rmw_event_t *>(events->events[i]);
-      auto custom_event_info = static_cast<CustomEventInfo *>(event->data);
-      custom_event_info->getListener()->detachCondition();
-      if (!custom_event_info->getListener()->hasEvent(event->event_type)) {
-        events->events[i] = nullptr;
-      }
-    }
+  for (size_t i = 0; i < subscription_count; ++i) {
+    subscriptions->subscribers[i] = nullptr;
+  }
+  for (size_t i = 0; i < client_count; ++i) {
+    clients->clients[i] = nullptr;
+  }
+  for (size_t i = 0; i < service_count; ++i) {
+    services->services[i] = nullptr;
+  }
+  for (size_t i = 0; i < event_count; ++i) {
+    events->events[i] = nullptr;
+  }
+  for (size_t i = 0; i < guard_condition_count; ++i) {
+    guard_conditions->guard_conditions[i] = nullptr;
+  }
+  for (const auto & ready_slot : wait_set_info->ready_slots) {
+    slot_handle(ready_slot.first, subscriptions, guard_conditions, services, clients, events) =
+      ready_slot.second;
   }
 
-  if (guard_conditions) {
-    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-      void * data = guard_conditions->guard_conditions[i];
-      auto guard_condition = static_cast<GuardCondition *>(data);
-      guard_condition->detachCondition();
-      if (!guard_condition->getHasTriggered()) {
-        guard_conditions->guard_conditions[i] = 0;
-      }
-    }
+  // Entities which were ready stay queued, and are checked again by the next call
+  wait_set_info->pending.swap(wait_set_info->ready);
+
+  {
+    std::lock_guard<std::mutex> cache_lock(wait_set_info->cache_mutex);
+    wait_set_info->in_use = false;
   }
 
   return timeout ? RMW_RET_TIMEOUT : RMW_RET_OK;
@@ -12,17 +12,127 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+#include <mutex>
+#include <set>
+
+#include "rcutils/get_env.h"
+
 #include "rmw/allocators.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 #include "rmw/impl/cpp/macros.hpp"
 
+#include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_event_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_service_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
 #include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
 
 #include "types/custom_wait_set_info.hpp"
+#include "types/guard_condition.hpp"
+
+namespace
+{
+std::mutex wait_sets_mutex;
+std::set<CustomWaitsetInfo *> wait_sets;
+
+// The wait set must not be in use
+void
+detach_cached_entities(CustomWaitsetInfo * wait_set_info)
+RCPPUTILS_TSA_REQUIRES(wait_set_info->cache_mutex)
+{
+  using rmw_fastrtps_shared_cpp::detach_if_owned;
+
+  rmw_fastrtps_shared_cpp::ReadyList * ready_list = &wait_set_info->ready_list;
+  for (void * data : wait_set_info->subscriptions) {
+    auto listener = static_cast<CustomSubscriberInfo *>(data)->listener_;
+    detach_if_owned(
+      listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+  }
+  for (void * data : wait_set_info->clients) {
+    auto listener = static_cast<CustomClientInfo *>(data)->listener_;
+    detach_if_owned(
+      listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+  }
+  for (void * data : wait_set_info->services) {
+    auto listener = static_cast<CustomServiceInfo *>(data)->listener_;
+    detach_if_owned(
+      listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+  }
+  for (void * data : wait_set_info->events) {
+    auto listener = static_cast<CustomEventInfo *>(data)->getListener();
+    detach_if_owned(
+      listener->getReadyListEntry(), ready_list, [listener]() {listener->detachCondition();});
+  }
+  for (void * data : wait_set_info->guard_conditions) {
+    auto guard_condition = static_cast<GuardCondition *>(data);
+    detach_if_owned(
+      guard_condition->getReadyListEntry(), ready_list,
+      [guard_condition]() {guard_condition->detachCondition();});
+  }
+  wait_set_info->subscriptions.clear();
+  wait_set_info->clients.clear();
+  wait_set_info->services.clear();
+  wait_set_info->events.clear();
+  wait_set_info->guard_conditions.clear();
+  wait_set_info->event_handles.clear();
+  rmw_fastrtps_shared_cpp::reset_ready_entries(wait_set_info);
+}
+}  // namespace
 
 namespace rmw_fastrtps_shared_cpp
 {
+void
+register_wait_set(CustomWaitsetInfo * wait_set_info)
+{
+  std::lock_guard<std::mutex> lock(wait_sets_mutex);
+  wait_sets.insert(wait_set_info);
+}
+
+void
+unregister_wait_set(CustomWaitsetInfo * wait_set_info)
+{
+  std::lock_guard<std::mutex> lock(wait_sets_mutex);
+  wait_sets.erase(wait_set_info);
+  std::lock_guard<std::mutex> cache_lock(wait_set_info->cache_mutex);
+  detach_cached_entities(wait_set_info);
+}
+
+void
+reset_ready_entries(CustomWaitsetInfo * wait_set_info)
+{
+  ReadyListEntry * entry = wait_set_info->ready_list.take_all();
+  while (entry != nullptr) {
+    // Read the next entry first, as a released entry can be pushed again at any time
+    ReadyListEntry * next = entry->next();
+    wait_set_info->ready_list.release(entry);
+    entry = next;
+  }
+  for (ReadyListEntry * pending_entry : wait_set_info->pending) {
+    wait_set_info->ready_list.release(pending_entry);
+  }
+  wait_set_info->pending.clear();
+  wait_set_info->adopted.clear();
+  wait_set_info->slots.clear();
+}
+
+void
+clean_wait_set_caches(ReadyListEntry * entry)
+{
+  std::lock_guard<std::mutex> lock(wait_sets_mutex);
+  for (CustomWaitsetInfo * wait_set_info : wait_sets) {
+    std::lock_guard<std::mutex> cache_lock(wait_set_info->cache_mutex);
+    // The entities of a wait set which is currently waiting are the ones it was called with,
+    // and destroying any of them while waiting on it is not allowed.
+    if (!wait_set_info->in_use &&
+      wait_set_info->slots.find(entry) != wait_set_info->slots.end())
+    {
+      detach_cached_entities(wait_set_info);
+    }
+  }
+}
+
 rmw_wait_set_t *
 __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t max_conditions)
 {
@@ -53,6 +163,15 @@ __rmw_create_wait_set(const char * identifier, rmw_context_t * context, size_t m
     RMW_SET_ERROR_MSG("failed to construct wait set info struct");
     goto fail;
   }
+  if (ReadyList::can_park()) {
+    // Check if parking on the ready list has been enabled from
+    // the RMW_FASTRTPS_USE_FUTEX_WAKEUP env variable.
+    const char * env_val = nullptr;
+    wait_set_info->use_park =
+      rcutils_get_env("RMW_FASTRTPS_USE_FUTEX_WAKEUP", &env_val) == nullptr &&
+      strcmp(env_val, "1") == 0;
+  }
+  register_wait_set(wait_set_info);
 
   return wait_set;
 
@@ -92,6 +211,8 @@ __rmw_destroy_wait_set(const char * identifier, rmw_wait_set_t * wait_set)
     return RMW_RET_ERROR;
   }
 
+  unregister_wait_set(wait_set_info);
+
   if (wait_set->data) {
     if (wait_set_info) {
       RMW_TRY_DESTRUCTOR(
@@ -0,0 +1,49 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "rmw_fastrtps_shared_cpp/namespace_prefix.hpp"
+#include "rmw_fastrtps_shared_cpp/topic_cache.hpp"
+
+#include "demangle.hpp"
+
+void
+TopicCache::addDemangledNames(const InternedString & topic_name, const InternedString & type_name)
+{
+  auto topic = demangled_topics_.find(topic_name);
+  if (topic == demangled_topics_.end()) {
+    DemangledTopic names;
+    names.is_ros_topic = _get_ros_prefix_if_exists(topic_name) == ros_topic_prefix;
+    names.topic_name = _demangle_if_ros_topic(topic_name);
+    names.service_name = _demangle_service_from_topic(topic_name);
+    topic = demangled_topics_.emplace(topic_name, std::move(names)).first;
+  }
+
+  auto type = demangled_types_.find(type_name);
+  if (type == demangled_types_.end()) {
+    DemangledTypeEntry entry;
+    entry.names.type_name = type_name.empty() ? std::string() : _demangle_if_ros_type(type_name);
+    entry.has_service_type_name = false;
+    entry.ref_count = 0;
+    type = demangled_types_.emplace(type_name, std::move(entry)).first;
+  }
+  ++type->second.ref_count;
+  // Only types of service topics are demangled as service types, other types would be
+  // reported as malformed service types
+  if (!type->second.has_service_type_name && !topic->second.service_name.empty()) {
+    type->second.names.service_type_name = _demangle_service_type_only(type_name);
+    type->second.has_service_type_name = true;
+  }
+}
@@ -17,11 +17,107 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/thread_safety_annotations.hpp"
+
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
+
+// Position of an entity in the rmw arrays passed to rmw_wait()
+typedef struct CustomWaitsetSlot
+{
+  enum Kind
+  {
+    SUBSCRIPTION,
+    CLIENT,
+    SERVICE,
+    EVENT,
+    GUARD_CONDITION
+  };
+
+  Kind kind;
+  size_t index;
+} CustomWaitsetSlot;
 
 typedef struct CustomWaitsetInfo
 {
   std::condition_variable condition;
   std::mutex condition_mutex;
+  // Park on ready_list instead of waiting on condition, so listeners never lock condition_mutex
+  bool use_park = false;
+
+  // Entities attached to condition / condition_mutex by the last call to rmw_wait().
+  // They stay attached between calls, so an unchanged set of entities does not have to be
+  // attached and detached again on every call. An entity can only be attached to one wait set
+  // at a time, the owner of its ready list entry tells whether it is still attached to this one.
+  std::mutex cache_mutex;
+  bool in_use RCPPUTILS_TSA_GUARDED_BY(cache_mutex) = false;
+  std::vector<void *> subscriptions RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+  std::vector<void *> guard_conditions RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+  std::vector<void *> services RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+  std::vector<void *> clients RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+  // CustomEventInfo pointers, taken from rmw_event_t::data
+  std::vector<void *> events RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+  // rmw_event_t pointers, only compared with the ones of the next call and never dereferenced
+  std::vector<void *> event_handles RCPPUTILS_TSA_GUARDED_BY(cache_mutex);
+
+  // Attached entities push themselves on ready_list when they become ready, so rmw_wait() only
+  // looks at those instead of checking every entity.
+  rmw_fastrtps_shared_cpp::ReadyList ready_list;
+  // The following are used by rmw_wait(), or with cache_mutex held while in_use is false.
+  // Slots of the entities attached by the last call, by ready list entry. A subscription and its
+  // events share a listener, thus an entry.
+  std::unordered_map<rmw_fastrtps_shared_cpp::ReadyListEntry *,
+    std::vector<CustomWaitsetSlot>> slots;
+  // Entries taken from ready_list which were ready when the last call returned; they are not
+  // released until found not ready anymore.
+  std::vector<rmw_fastrtps_shared_cpp::ReadyListEntry *> pending;
+  // Entries of attached entities which are still held by the wait set they were attached to
+  // before, checked directly on every call until that wait set releases them.
+  std::vector<rmw_fastrtps_shared_cpp::ReadyListEntry *> adopted;
+  // Scratch storage reused across calls
+  std::vector<rmw_fastrtps_shared_cpp::ReadyListEntry *> ready;
+  std::vector<std::pair<CustomWaitsetSlot, void *>> ready_slots;
 } CustomWaitsetInfo;
 
+namespace rmw_fastrtps_shared_cpp
+{
+
+/// Make a wait set known to clean_wait_set_caches().
+void
+register_wait_set(CustomWaitsetInfo * wait_set_info);
+
+/// Detach every cached entity of a wait set and forget about it.
+void
+unregister_wait_set(CustomWaitsetInfo * wait_set_info);
+
+/// Release every entry taken from or queued on the ready list of a wait set, and forget slots.
+void
+reset_ready_entries(CustomWaitsetInfo * wait_set_info);
+
+/// Detach the cached entities of the wait sets which hold an entity, unless they are waiting.
+/**
+ * Must be called before an entity which may be attached to a wait set is destroyed, so no wait
+ * set is left holding a pointer to it. Wait sets which do not hold the entity are left as is.
+ *
+ * \param entry the ready list entry of the entity
+ */
+void
+clean_wait_set_caches(ReadyListEntry * entry);
+
+/// Detach an entity from a wait set, unless another wait set attached it since.
+template<typename DetachT>
+void
+detach_if_owned(ReadyListEntry * entry, ReadyList * ready_list, DetachT detach)
+{
+  if (entry->owner() == ready_list) {
+    detach();
+    entry->set_owner(nullptr);
+  }
+}
+
+}  // namespace rmw_fastrtps_shared_cpp
+
 #endif  // TYPES__CUSTOM_WAIT_SET_INFO_HPP_
@@ -24,12 +24,14 @@
 
 #include "rcpputils/thread_safety_annotations.hpp"
 
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
+
 class GuardCondition
 {
 public:
   GuardCondition()
   : hasTriggered_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+    conditionMutex_(nullptr), conditionVariable_(nullptr), readyList_(nullptr) {}
 
   void
   trigger()
@@ -42,19 +44,28 @@ public:
       // rmw_wait() which checks hasTriggered() and decides if wait() needs to
       // be called
       hasTriggered_ = true;
+      readyList_->push(&readyListEntry_);
       clock.unlock();
       conditionVariable_->notify_one();
     } else {
       hasTriggered_ = true;
+      if (readyList_ != nullptr) {
+        // Attached to a wait set which parks on its ready list
+        readyList_->push(&readyListEntry_);
+      }
     }
   }
 
   void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  attachCondition(
+    std::mutex * conditionMutex,
+    std::condition_variable * conditionVariable,
+    rmw_fastrtps_shared_cpp::ReadyList * readyList)
   {
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = conditionMutex;
     conditionVariable_ = conditionVariable;
+    readyList_ = readyList;
   }
 
   void
@@ -63,6 +74,13 @@ public:
     std::lock_guard<std::mutex> lock(internalMutex_);
     conditionMutex_ = nullptr;
     conditionVariable_ = nullptr;
+    readyList_ = nullptr;
+  }
+
+  rmw_fastrtps_shared_cpp::ReadyListEntry *
+  getReadyListEntry()
+  {
+    return &readyListEntry_;
   }
 
   bool
@@ -82,6 +100,8 @@ private:
   std::atomic_bool hasTriggered_;
   std::mutex * conditionMutex_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
   std::condition_variable * conditionVariable_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyList * readyList_ RCPPUTILS_TSA_GUARDED_BY(internalMutex_);
+  rmw_fastrtps_shared_cpp::ReadyListEntry readyListEntry_;
 };
 
 #endif  // TYPES__GUARD_CONDITION_HPP_
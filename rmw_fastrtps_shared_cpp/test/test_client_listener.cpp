@@ -0,0 +1,170 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_client_info.hpp"
+
+using std::chrono::steady_clock;
+using RequestState = ClientListener::RequestState;
+
+namespace
+{
+CustomClientResponse
+make_response(int64_t sequence_number)
+{
+  CustomClientResponse response;
+  response.sample_identity_.sequence_number().high =
+    static_cast<int32_t>(sequence_number >> 32);
+  response.sample_identity_.sequence_number().low =
+    static_cast<uint32_t>(sequence_number & 0xFFFFFFFF);
+  response.buffer_.reset(new eprosima::fastcdr::FastBuffer());
+  return response;
+}
+}  // namespace
+
+class ClientListenerTestFixture : public ::testing::Test
+{
+public:
+  ClientListener listener{nullptr, 4};
+
+  bool push(int64_t sequence_number)
+  {
+    CustomClientResponse response = make_response(sequence_number);
+    return listener.pushResponse(response);
+  }
+};
+
+TEST_F(ClientListenerTestFixture, test_take_by_sequence_number)
+{
+  listener.addRequest(1, steady_clock::time_point::max());
+  listener.addRequest(2, steady_clock::time_point::max());
+  CustomClientResponse response;
+  EXPECT_EQ(RequestState::pending, listener.getResponse(1, response));
+
+  ASSERT_TRUE(push(1));
+  ASSERT_TRUE(push(2));
+  EXPECT_TRUE(listener.hasData());
+
+  // Out of order
+  EXPECT_EQ(RequestState::completed, listener.getResponse(2, response));
+  EXPECT_EQ(2, ClientListener::getSequenceNumber(response.sample_identity_));
+  EXPECT_TRUE(listener.hasData());
+  EXPECT_EQ(RequestState::unknown, listener.getResponse(2, response));
+
+  // The response taken by sequence number is skipped
+  ASSERT_TRUE(listener.getResponse(response));
+  EXPECT_EQ(1, ClientListener::getSequenceNumber(response.sample_identity_));
+  EXPECT_FALSE(listener.hasData());
+  EXPECT_FALSE(listener.getResponse(response));
+}
+
+TEST_F(ClientListenerTestFixture, test_stale_responses_dropped)
+{
+  listener.addRequest(1, steady_clock::time_point::max());
+  ASSERT_TRUE(push(1));
+  // Duplicate
+  EXPECT_FALSE(push(1));
+
+  CustomClientResponse response;
+  ASSERT_TRUE(listener.getResponse(response));
+  // Already taken
+  EXPECT_FALSE(push(1));
+  EXPECT_FALSE(listener.hasData());
+}
+
+TEST_F(ClientListenerTestFixture, test_request_timed_out)
+{
+  listener.addRequest(1, steady_clock::now() - std::chrono::seconds(1));
+  CustomClientResponse response = make_response(1);
+  EXPECT_FALSE(listener.expectsResponse(response.sample_identity_));
+  EXPECT_FALSE(listener.pushResponse(response));
+  EXPECT_FALSE(listener.hasData());
+
+  EXPECT_EQ(RequestState::timed_out, listener.getResponse(1, response));
+  // Forgotten once reported
+  EXPECT_EQ(RequestState::unknown, listener.getResponse(1, response));
+}
+
+TEST_F(ClientListenerTestFixture, test_response_before_request_tracked)
+{
+  // The response may arrive before the call sending the request returns
+  CustomClientResponse response = make_response(1);
+  EXPECT_TRUE(listener.expectsResponse(response.sample_identity_));
+  ASSERT_TRUE(listener.pushResponse(response));
+  listener.addRequest(1, steady_clock::now() - std::chrono::seconds(1));
+
+  EXPECT_EQ(RequestState::completed, listener.getResponse(1, response));
+}
+
+TEST_F(ClientListenerTestFixture, test_requests_never_dropped)
+{
+  // Many more requests than slots, none answered yet
+  for (int64_t sequence_number = 1; sequence_number <= 100; ++sequence_number) {
+    listener.addRequest(sequence_number, steady_clock::time_point::max());
+  }
+  CustomClientResponse response;
+  for (int64_t sequence_number = 1; sequence_number <= 100; ++sequence_number) {
+    EXPECT_EQ(RequestState::pending, listener.getResponse(sequence_number, response));
+  }
+
+  // Answered out of order, some taken by sequence number, the others in order of arrival
+  for (int64_t sequence_number = 100; sequence_number >= 1; --sequence_number) {
+    ASSERT_TRUE(push(sequence_number));
+  }
+  for (int64_t sequence_number = 2; sequence_number <= 100; sequence_number += 2) {
+    ASSERT_EQ(RequestState::completed, listener.getResponse(sequence_number, response));
+    EXPECT_EQ(sequence_number, ClientListener::getSequenceNumber(response.sample_identity_));
+  }
+  for (int64_t sequence_number = 99; sequence_number >= 1; sequence_number -= 2) {
+    ASSERT_TRUE(listener.getResponse(response));
+    EXPECT_EQ(sequence_number, ClientListener::getSequenceNumber(response.sample_identity_));
+  }
+  EXPECT_FALSE(listener.hasData());
+  EXPECT_FALSE(listener.getResponse(response));
+  EXPECT_EQ(RequestState::unknown, listener.getResponse(1, response));
+}
+
+TEST_F(ClientListenerTestFixture, test_timed_out_requests_purged)
+{
+  listener.addRequest(1, steady_clock::now() + std::chrono::milliseconds(10));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  // Purged when the next request is sent, without being polled
+  listener.addRequest(2, steady_clock::time_point::max());
+  CustomClientResponse response = make_response(1);
+  EXPECT_FALSE(listener.pushResponse(response));
+
+  EXPECT_EQ(RequestState::pending, listener.getResponse(2, response));
+  EXPECT_EQ(RequestState::timed_out, listener.getResponse(1, response));
+  EXPECT_EQ(RequestState::unknown, listener.getResponse(1, response));
+}
+
+TEST_F(ClientListenerTestFixture, test_server_available_once_both_endpoints_matched)
+{
+  CustomClientInfo info;
+  info.server_available_ = false;
+  ClientListener client_listener(&info);
+
+  client_listener.requestSubscribersMatched(1);
+  EXPECT_FALSE(info.server_available_.load());
+  client_listener.responsePublishersMatched(2);
+  EXPECT_TRUE(info.server_available_.load());
+
+  client_listener.requestSubscribersMatched(0);
+  EXPECT_FALSE(info.server_available_.load());
+}
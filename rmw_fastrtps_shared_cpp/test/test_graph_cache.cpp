@@ -0,0 +1,217 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/graph_cache.hpp"
+
+#include "fastrtps/qos/WriterQos.h"
+
+using eprosima::fastrtps::WriterQos;
+using eprosima::fastrtps::rtps::GUID_t;
+using eprosima::fastrtps::rtps::GuidPrefix_t;
+using eprosima::fastrtps::rtps::octet;
+
+class GraphCacheTestFixture : public ::testing::Test
+{
+public:
+  GraphCache graph_cache;
+  WriterQos qos;
+  GUID_t participant_guid;
+  GUID_t guid[2];
+  std::vector<octet> node_user_data;
+
+  void SetUp()
+  {
+    GuidPrefix_t prefix;
+    prefix.value[0] = 1;
+    participant_guid = GUID_t(prefix, 1);
+    guid[0] = GUID_t(prefix, 100);
+    guid[1] = GUID_t(prefix, 101);
+    const std::string user_data("name=node;namespace=/ns;");
+    node_user_data.assign(user_data.begin(), user_data.end());
+  }
+
+  size_t topic_count(const std::string & topic_name)
+  {
+    const auto & topic_name_to_data = graph_cache.writer_topic_cache().getTopicNameToTopicData();
+    auto it = topic_name_to_data.find(topic_name);
+    return it == topic_name_to_data.end() ? 0u : it->second.size();
+  }
+};
+
+TEST_F(GraphCacheTestFixture, test_get_for_domain)
+{
+  auto domain_graph_cache = GraphCache::get_for_domain(0, false);
+  EXPECT_EQ(domain_graph_cache, GraphCache::get_for_domain(0, false));
+  EXPECT_NE(domain_graph_cache, GraphCache::get_for_domain(1, false));
+  EXPECT_NE(domain_graph_cache, GraphCache::get_for_domain(0, true));
+}
+
+TEST_F(GraphCacheTestFixture, test_endpoint_reported_by_several_participants)
+{
+  // Two participants of the process discover the same publisher
+  EXPECT_TRUE(
+    graph_cache.add_endpoint(participant_guid, guid[0], "topic", "type", qos, {}, false));
+  EXPECT_FALSE(
+    graph_cache.add_endpoint(participant_guid, guid[0], "topic", "type", qos, {}, false));
+  EXPECT_EQ(1u, topic_count("topic"));
+
+  // It stays until both of them reported its removal
+  EXPECT_FALSE(graph_cache.remove_endpoint(guid[0]));
+  EXPECT_EQ(1u, topic_count("topic"));
+  EXPECT_TRUE(graph_cache.remove_endpoint(guid[0]));
+  EXPECT_EQ(0u, topic_count("topic"));
+  EXPECT_FALSE(graph_cache.remove_endpoint(guid[0]));
+}
+
+TEST_F(GraphCacheTestFixture, test_endpoints_listed_under_their_node)
+{
+  graph_cache.add_participant(participant_guid, "", "");
+  graph_cache.add_endpoint(participant_guid, guid[0], "topic", "type", qos, node_user_data, false);
+  graph_cache.add_endpoint(participant_guid, guid[1], "other", "type", qos, node_user_data, false);
+
+  auto nodes = graph_cache.get_discovered_nodes();
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ("node", nodes[0].name);
+  EXPECT_EQ("/ns", nodes[0].namespace_);
+
+  GUID_t node_guid = nodes[0].guid;
+  EXPECT_NE(participant_guid, node_guid);
+  const auto & participant_to_topics = graph_cache.writer_topic_cache().getParticipantToTopics();
+  auto it = participant_to_topics.find(node_guid);
+  ASSERT_TRUE(it != participant_to_topics.end());
+  EXPECT_EQ(2u, it->second.size());
+
+  // The node goes away along with its last endpoint
+  graph_cache.remove_endpoint(guid[0]);
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+  graph_cache.remove_endpoint(guid[1]);
+  EXPECT_TRUE(graph_cache.get_discovered_nodes().empty());
+}
+
+TEST_F(GraphCacheTestFixture, test_node_announcement)
+{
+  // A node without other endpoints is discovered through its announcement
+  EXPECT_TRUE(
+    graph_cache.add_endpoint(
+      participant_guid, guid[0], node_announcement_topic_name, "type", qos, node_user_data,
+      false));
+  auto nodes = graph_cache.get_discovered_nodes();
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ("node", nodes[0].name);
+  EXPECT_EQ(0u, topic_count(node_announcement_topic_name));
+  EXPECT_TRUE(graph_cache.writer_topic_cache().getParticipantToTopics().empty());
+
+  EXPECT_TRUE(graph_cache.remove_endpoint(guid[0]));
+  EXPECT_TRUE(graph_cache.get_discovered_nodes().empty());
+}
+
+TEST_F(GraphCacheTestFixture, test_local_node)
+{
+  GUID_t node_guid = graph_cache.add_local_node(participant_guid, "node", "/ns");
+  graph_cache.add_endpoint(participant_guid, guid[0], "topic", "type", qos, node_user_data, false);
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+  const auto & participant_to_topics = graph_cache.writer_topic_cache().getParticipantToTopics();
+  EXPECT_TRUE(participant_to_topics.find(node_guid) != participant_to_topics.end());
+
+  // The node is still listed while it has endpoints
+  graph_cache.remove_local_node(node_guid);
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+  graph_cache.remove_endpoint(guid[0]);
+  EXPECT_TRUE(graph_cache.get_discovered_nodes().empty());
+}
+
+TEST_F(GraphCacheTestFixture, test_participant_reported_by_several_participants)
+{
+  graph_cache.add_participant(participant_guid, "node", "/ns");
+  graph_cache.add_participant(participant_guid, "node", "/ns");
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+  graph_cache.remove_participant(participant_guid);
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+  graph_cache.remove_participant(participant_guid);
+  EXPECT_TRUE(graph_cache.get_discovered_nodes().empty());
+}
+
+TEST_F(GraphCacheTestFixture, test_participant_removal_forgets_its_nodes)
+{
+  graph_cache.add_participant(participant_guid, "", "");
+  graph_cache.add_endpoint(participant_guid, guid[0], "topic", "type", qos, node_user_data, false);
+  EXPECT_EQ(1u, graph_cache.get_discovered_nodes().size());
+
+  // The participant went away without its endpoints being removed
+  graph_cache.remove_participant(participant_guid);
+  EXPECT_TRUE(graph_cache.get_discovered_nodes().empty());
+
+  // The node is known again once rediscovered
+  graph_cache.add_participant(participant_guid, "", "");
+  graph_cache.add_endpoint(participant_guid, guid[1], "topic", "type", qos, node_user_data, false);
+  auto nodes = graph_cache.get_discovered_nodes();
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ("node", nodes[0].name);
+}
+
+TEST_F(GraphCacheTestFixture, test_node_guid_by_name)
+{
+  GUID_t found;
+  EXPECT_FALSE(graph_cache.get_node_guid("node", "/ns", found));
+
+  GUID_t node_guid = graph_cache.add_local_node(participant_guid, "node", "/ns");
+  ASSERT_TRUE(graph_cache.get_node_guid("node", "/ns", found));
+  EXPECT_EQ(node_guid, found);
+  EXPECT_FALSE(graph_cache.get_node_guid("node", "/other", found));
+  EXPECT_FALSE(graph_cache.get_node_guid("other", "/ns", found));
+
+  graph_cache.add_participant(participant_guid, "other", "/ns");
+  ASSERT_TRUE(graph_cache.get_node_guid("other", "/ns", found));
+  EXPECT_EQ(participant_guid, found);
+
+  graph_cache.remove_local_node(node_guid);
+  EXPECT_FALSE(graph_cache.get_node_guid("node", "/ns", found));
+  // Nodes of a participant are forgotten along with it
+  graph_cache.add_local_node(participant_guid, "node", "/ns");
+  graph_cache.remove_participant(participant_guid);
+  EXPECT_FALSE(graph_cache.get_node_guid("other", "/ns", found));
+  EXPECT_FALSE(graph_cache.get_node_guid("node", "/ns", found));
+}
+
+TEST_F(GraphCacheTestFixture, test_node_name_by_guid)
+{
+  std::string name;
+  std::string namespace_;
+  EXPECT_FALSE(graph_cache.get_node_name(participant_guid, name, namespace_));
+
+  GUID_t node_guid = graph_cache.add_local_node(participant_guid, "node", "/ns");
+  graph_cache.add_participant(participant_guid, "other", "/ns");
+  ASSERT_TRUE(graph_cache.get_node_name(node_guid, name, namespace_));
+  EXPECT_EQ("node", name);
+  EXPECT_EQ("/ns", namespace_);
+  ASSERT_TRUE(graph_cache.get_node_name(participant_guid, name, namespace_));
+  EXPECT_EQ("other", name);
+  EXPECT_EQ("/ns", namespace_);
+
+  // Removing a node does not change the name of the others
+  graph_cache.remove_local_node(node_guid);
+  EXPECT_FALSE(graph_cache.get_node_name(node_guid, name, namespace_));
+  ASSERT_TRUE(graph_cache.get_node_name(participant_guid, name, namespace_));
+  EXPECT_EQ("other", name);
+  auto nodes = graph_cache.get_discovered_nodes();
+  ASSERT_EQ(1u, nodes.size());
+  EXPECT_EQ(participant_guid, nodes[0].guid);
+}
@@ -0,0 +1,83 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/interned_string.hpp"
+
+using rmw_fastrtps_shared_cpp::InternedString;
+
+TEST(InternedStringTest, test_equal_strings_share_storage)
+{
+  InternedString a("rt/chatter");
+  InternedString b(std::string("rt/chatter"));
+  InternedString c("rt/other");
+  EXPECT_EQ(a.id(), b.id());
+  EXPECT_EQ(&a.str(), &b.str());
+  EXPECT_NE(a.id(), c.id());
+  EXPECT_TRUE(a == b);
+  EXPECT_TRUE(a != c);
+  EXPECT_TRUE(a == "rt/chatter");
+  EXPECT_TRUE(std::string("rt/chatter") == a);
+  EXPECT_EQ("rt/chatter", a.str());
+}
+
+TEST(InternedStringTest, test_empty_string)
+{
+  InternedString empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ("", empty.str());
+  EXPECT_TRUE(empty == InternedString(""));
+  EXPECT_FALSE(InternedString("a").empty());
+}
+
+TEST(InternedStringTest, test_find)
+{
+  InternedString found;
+  EXPECT_FALSE(InternedString::find("rt/not_interned", found));
+  {
+    InternedString interned("rt/interned");
+    ASSERT_TRUE(InternedString::find("rt/interned", found));
+    EXPECT_EQ(interned, found);
+  }
+  // Still interned while a copy exists
+  ASSERT_TRUE(InternedString::find("rt/interned", found));
+  found = InternedString();
+  // and freed with the last one
+  EXPECT_FALSE(InternedString::find("rt/interned", found));
+}
+
+TEST(InternedStringTest, test_intern_and_release_concurrently)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      []() {
+        for (int j = 0; j < 10000; ++j) {
+          InternedString a("rt/shared");
+          InternedString b("rt/shared");
+          ASSERT_EQ(a, b);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  InternedString found;
+  EXPECT_FALSE(InternedString::find("rt/shared", found));
+}
@@ -0,0 +1,56 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/loaned_message_pool.hpp"
+
+using rmw_fastrtps_shared_cpp::LoanedMessagePool;
+
+static void noop(void *) {}
+
+TEST(LoanedMessagePoolTest, test_reuse_given_back_message)
+{
+  LoanedMessagePool pool(sizeof(int), 1, noop, noop);
+  void * message = pool.borrow();
+  ASSERT_NE(nullptr, message);
+  EXPECT_TRUE(pool.is_loaned(message));
+  EXPECT_TRUE(pool.give_back(message));
+  EXPECT_FALSE(pool.is_loaned(message));
+  EXPECT_EQ(message, pool.borrow());
+}
+
+TEST(LoanedMessagePoolTest, test_reject_double_give_back)
+{
+  LoanedMessagePool pool(sizeof(int), 1, noop, noop);
+  void * message = pool.borrow();
+  ASSERT_NE(nullptr, message);
+  EXPECT_TRUE(pool.give_back(message));
+  EXPECT_FALSE(pool.give_back(message));
+
+  // The message must be available once only
+  void * first = pool.borrow();
+  void * second = pool.borrow();
+  EXPECT_EQ(message, first);
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(pool.give_back(first));
+  EXPECT_TRUE(pool.give_back(second));
+}
+
+TEST(LoanedMessagePoolTest, test_reject_foreign_message)
+{
+  LoanedMessagePool pool(sizeof(int), 1, noop, noop);
+  int foreign = 0;
+  EXPECT_FALSE(pool.is_loaned(&foreign));
+  EXPECT_FALSE(pool.give_back(&foreign));
+}
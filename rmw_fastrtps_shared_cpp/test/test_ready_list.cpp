@@ -0,0 +1,196 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/ready_list.hpp"
+
+using rmw_fastrtps_shared_cpp::ReadyList;
+using rmw_fastrtps_shared_cpp::ReadyListEntry;
+
+namespace
+{
+std::vector<ReadyListEntry *>
+take_all(ReadyList & ready_list)
+{
+  std::vector<ReadyListEntry *> entries;
+  for (ReadyListEntry * entry = ready_list.take_all(); entry != nullptr; entry = entry->next()) {
+    entries.push_back(entry);
+  }
+  return entries;
+}
+}  // namespace
+
+TEST(TestReadyList, push_and_take_all)
+{
+  ReadyList ready_list;
+  ReadyListEntry first, second;
+  EXPECT_TRUE(ready_list.empty());
+  EXPECT_EQ(nullptr, ready_list.take_all());
+
+  EXPECT_TRUE(ready_list.push(&first));
+  EXPECT_TRUE(ready_list.push(&second));
+  EXPECT_FALSE(ready_list.empty());
+  // Already queued
+  EXPECT_FALSE(ready_list.push(&first));
+
+  std::vector<ReadyListEntry *> entries = take_all(ready_list);
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(&second, entries[0]);
+  EXPECT_EQ(&first, entries[1]);
+  EXPECT_TRUE(ready_list.empty());
+
+  // Held until released
+  EXPECT_EQ(&ready_list, first.queued_in());
+  EXPECT_FALSE(ready_list.push(&first));
+  EXPECT_TRUE(ready_list.empty());
+  ready_list.release(&first);
+  EXPECT_EQ(nullptr, first.queued_in());
+  EXPECT_TRUE(ready_list.push(&first));
+  EXPECT_EQ(&first, ready_list.take_all());
+}
+
+TEST(TestReadyList, claim)
+{
+  ReadyList ready_list;
+  ReadyListEntry entry;
+  EXPECT_TRUE(ready_list.claim(&entry));
+  EXPECT_FALSE(ready_list.claim(&entry));
+  // Held as if taken, not queued
+  EXPECT_FALSE(ready_list.push(&entry));
+  EXPECT_TRUE(ready_list.empty());
+  ready_list.release(&entry);
+  EXPECT_TRUE(ready_list.push(&entry));
+}
+
+TEST(TestReadyList, entry_held_by_another_list)
+{
+  ReadyList previous, current;
+  ReadyListEntry entry;
+  ASSERT_TRUE(previous.push(&entry));
+  ASSERT_EQ(&entry, previous.take_all());
+
+  // Only the list holding the entry releases it
+  current.release(&entry);
+  EXPECT_EQ(&previous, entry.queued_in());
+  EXPECT_FALSE(current.claim(&entry));
+
+  // The push fails, but the consumer of the list is told to look
+  EXPECT_FALSE(current.push(&entry));
+  EXPECT_FALSE(current.empty());
+  EXPECT_EQ(nullptr, current.take_all());
+  EXPECT_TRUE(current.empty());
+
+  previous.release(&entry);
+  EXPECT_TRUE(current.push(&entry));
+  EXPECT_EQ(&entry, current.take_all());
+}
+
+TEST(TestReadyList, concurrent_pushes)
+{
+  ReadyList ready_list;
+  std::vector<ReadyListEntry> entries(1000);
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < 4; ++producer) {
+    producers.emplace_back(
+      [&ready_list, &entries, producer]() {
+        for (size_t i = producer; i < entries.size(); i += 4) {
+          ready_list.push(&entries[i]);
+        }
+      });
+  }
+  size_t taken = 0;
+  while (taken < entries.size()) {
+    taken += take_all(ready_list).size();
+  }
+  for (std::thread & producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(entries.size(), taken);
+  EXPECT_TRUE(ready_list.empty());
+}
+
+TEST(TestReadyList, park_times_out)
+{
+  if (!ReadyList::can_park()) {
+    return;
+  }
+  ReadyList ready_list;
+  std::chrono::nanoseconds timeout = std::chrono::milliseconds(20);
+  auto start = std::chrono::steady_clock::now();
+  // May return early, callers check again
+  while (std::chrono::steady_clock::now() - start < timeout) {
+    ready_list.park(&timeout);
+  }
+  EXPECT_TRUE(ready_list.empty());
+
+  // Does not block when not empty
+  ReadyListEntry entry;
+  ready_list.push(&entry);
+  ready_list.park(nullptr);
+}
+
+TEST(TestReadyList, park_woken_by_push)
+{
+  if (!ReadyList::can_park()) {
+    return;
+  }
+  ReadyList ready_list;
+  std::vector<ReadyListEntry> entries(200);
+  std::thread producer(
+    [&ready_list, &entries]() {
+      for (ReadyListEntry & entry : entries) {
+        ready_list.push(&entry);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    });
+  size_t taken = 0;
+  while (taken < entries.size()) {
+    std::vector<ReadyListEntry *> batch = take_all(ready_list);
+    if (batch.empty()) {
+      // Without a timeout, a missed wake up hangs the test
+      ready_list.park(nullptr);
+    }
+    taken += batch.size();
+  }
+  producer.join();
+  EXPECT_EQ(entries.size(), taken);
+}
+
+TEST(TestReadyList, park_woken_by_push_of_entry_held_elsewhere)
+{
+  if (!ReadyList::can_park()) {
+    return;
+  }
+  ReadyList previous, current;
+  ReadyListEntry entry;
+  ASSERT_TRUE(previous.claim(&entry));
+  std::atomic_bool pushed(false);
+  std::thread producer(
+    [&current, &entry, &pushed]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      pushed = !current.push(&entry);
+    });
+  while (current.empty()) {
+    current.park(nullptr);
+  }
+  producer.join();
+  EXPECT_TRUE(pushed);
+  EXPECT_EQ(nullptr, current.take_all());
+}
@@ -0,0 +1,62 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/ring_buffer.hpp"
+
+using rmw_fastrtps_shared_cpp::RingBuffer;
+
+TEST(RingBufferTest, test_fifo_order)
+{
+  RingBuffer<int> ring;
+  EXPECT_TRUE(ring.empty());
+  for (int i = 0; i < 3; ++i) {
+    ring.push_back(int(i));
+  }
+  EXPECT_EQ(3u, ring.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, ring.front());
+    ring.pop_front();
+  }
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(RingBufferTest, test_grow_while_wrapped_around)
+{
+  RingBuffer<std::unique_ptr<int>> ring;
+  int next_pushed = 0;
+  int next_popped = 0;
+  // Move the head forward so the elements wrap around the end of the storage when it grows
+  for (; next_pushed < 3; ++next_pushed) {
+    ring.push_back(std::unique_ptr<int>(new int(next_pushed)));
+  }
+  for (; next_popped < 2; ++next_popped) {
+    EXPECT_EQ(next_popped, *ring.front());
+    ring.pop_front();
+  }
+  for (; next_pushed < 20; ++next_pushed) {
+    ring.push_back(std::unique_ptr<int>(new int(next_pushed)));
+  }
+  EXPECT_EQ(18u, ring.size());
+  for (; next_popped < 20; ++next_popped) {
+    std::unique_ptr<int> value = std::move(ring.front());
+    ring.pop_front();
+    ASSERT_TRUE(value != nullptr);
+    EXPECT_EQ(next_popped, *value);
+  }
+  EXPECT_TRUE(ring.empty());
+}
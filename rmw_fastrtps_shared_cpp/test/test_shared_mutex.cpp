@@ -0,0 +1,115 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rmw_fastrtps_shared_cpp/shared_mutex.hpp"
+
+using rmw_fastrtps_shared_cpp::SharedMutex;
+
+TEST(TestSharedMutex, readers_share_writers_exclude)
+{
+  SharedMutex mutex;
+  {
+    std::shared_lock<SharedMutex> first(mutex);
+    std::shared_lock<SharedMutex> second(mutex, std::try_to_lock);
+    EXPECT_TRUE(second.owns_lock());
+    EXPECT_FALSE(mutex.try_lock());
+  }
+  {
+    std::unique_lock<SharedMutex> writer(mutex);
+    EXPECT_FALSE(mutex.try_lock());
+    EXPECT_FALSE(mutex.try_lock_shared());
+  }
+  EXPECT_TRUE(mutex.try_lock_shared());
+  mutex.unlock_shared();
+}
+
+TEST(TestSharedMutex, waiting_writer_holds_off_new_readers)
+{
+  SharedMutex mutex;
+  std::atomic_bool written(false);
+  mutex.lock_shared();
+
+  std::thread writer([&mutex, &written]() {
+      std::lock_guard<SharedMutex> guard(mutex);
+      written = true;
+    });
+  // Wait for the writer to queue up behind the reader
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  bool writer_waiting = false;
+  while (!writer_waiting && std::chrono::steady_clock::now() < deadline) {
+    if (mutex.try_lock_shared()) {
+      mutex.unlock_shared();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } else {
+      writer_waiting = true;
+    }
+  }
+  EXPECT_TRUE(writer_waiting);
+  EXPECT_FALSE(written);
+
+  // Readers coming later wait for the writer
+  std::atomic_bool read_after_write(false);
+  std::thread reader([&mutex, &written, &read_after_write]() {
+      std::shared_lock<SharedMutex> guard(mutex);
+      read_after_write = written.load();
+    });
+
+  mutex.unlock_shared();
+  writer.join();
+  reader.join();
+  EXPECT_TRUE(written);
+  EXPECT_TRUE(read_after_write);
+}
+
+TEST(TestSharedMutex, concurrent_readers_and_writers)
+{
+  SharedMutex mutex;
+  size_t value = 0;
+  std::atomic<size_t> readers(0);
+  std::atomic_bool overlap(false);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+        for (size_t n = 0; n < 1000; ++n) {
+          std::lock_guard<SharedMutex> guard(mutex);
+          if (readers != 0) {
+            overlap = true;
+          }
+          ++value;
+        }
+      });
+    threads.emplace_back([&]() {
+        for (size_t n = 0; n < 1000; ++n) {
+          std::shared_lock<SharedMutex> guard(mutex);
+          ++readers;
+          (void)value;
+          --readers;
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(overlap);
+  EXPECT_EQ(4000u, value);
+}
@@ -0,0 +1,257 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <thread>
+
+#include "fastrtps/Domain.h"
+#include "fastrtps/attributes/ParticipantAttributes.h"
+#include "fastrtps/attributes/PublisherAttributes.h"
+#include "fastrtps/attributes/SubscriberAttributes.h"
+#include "fastrtps/participant/Participant.h"
+#include "fastrtps/publisher/Publisher.h"
+#include "fastrtps/subscriber/Subscriber.h"
+
+#include "gtest/gtest.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/rmw.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+using eprosima::fastrtps::Domain;
+
+namespace
+{
+const char * const identifier = "test_take_sequence";
+
+uint64_t
+unread_count(eprosima::fastrtps::Subscriber * sub)
+{
+#if FASTRTPS_VERSION_MAJOR == 1 && FASTRTPS_VERSION_MINOR < 9
+  return sub->getUnreadCount();
+#else
+  return sub->get_unread_count();
+#endif
+}
+}  // namespace
+
+// Messages are a single uint32_t
+class TestTypeSupport : public rmw_fastrtps_shared_cpp::TypeSupport
+{
+public:
+  TestTypeSupport()
+  {
+    setName("test_take_sequence::msg::UInt32");
+    max_size_bound_ = true;
+    m_typeSize = 8;
+  }
+
+  size_t getEstimatedSerializedSize(const void *, const void *) override
+  {
+    return 8;
+  }
+
+  bool serializeROSmessage(
+    const void * ros_message, eprosima::fastcdr::Cdr & ser, const void *) override
+  {
+    ser.serialize_encapsulation();
+    ser << *static_cast<const uint32_t *>(ros_message);
+    return true;
+  }
+
+  bool deserializeROSmessage(
+    eprosima::fastcdr::Cdr & deser, void * ros_message, const void *) override
+  {
+    deser.read_encapsulation();
+    deser >> *static_cast<uint32_t *>(ros_message);
+    return true;
+  }
+};
+
+class TakeSequenceTestFixture : public ::testing::Test
+{
+public:
+  eprosima::fastrtps::Participant * participant = nullptr;
+  TestTypeSupport * type_support = nullptr;
+  eprosima::fastrtps::Publisher * publisher = nullptr;
+  CustomSubscriberInfo info;
+  rmw_subscription_t subscription;
+  uint32_t messages[4];
+  void * message_pointers[4];
+  rmw_message_info_t message_infos[4];
+  size_t taken;
+
+  void SetUp()
+  {
+    info.listener_ = nullptr;
+
+    eprosima::fastrtps::ParticipantAttributes participant_attrs;
+    Domain::getDefaultParticipantAttributes(participant_attrs);
+    participant = Domain::createParticipant(participant_attrs, nullptr);
+    ASSERT_NE(nullptr, participant);
+    type_support = new TestTypeSupport();
+    ASSERT_TRUE(Domain::registerType(participant, type_support));
+
+    // Reliable and transient local, so no sample is lost while the endpoints match
+    eprosima::fastrtps::PublisherAttributes publisher_attrs;
+    Domain::getDefaultPublisherAttributes(publisher_attrs);
+    publisher_attrs.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    publisher_attrs.topic.topicDataType = type_support->getName();
+    publisher_attrs.topic.topicName = "test_take_sequence";
+    publisher_attrs.topic.historyQos.kind = eprosima::fastrtps::KEEP_ALL_HISTORY_QOS;
+    publisher_attrs.qos.m_durability.kind = eprosima::fastrtps::TRANSIENT_LOCAL_DURABILITY_QOS;
+    publisher_attrs.qos.m_reliability.kind = eprosima::fastrtps::RELIABLE_RELIABILITY_QOS;
+    publisher = Domain::createPublisher(participant, publisher_attrs, nullptr);
+    ASSERT_NE(nullptr, publisher);
+
+    eprosima::fastrtps::SubscriberAttributes subscriber_attrs;
+    Domain::getDefaultSubscriberAttributes(subscriber_attrs);
+    subscriber_attrs.topic = publisher_attrs.topic;
+    subscriber_attrs.qos.m_durability.kind = eprosima::fastrtps::TRANSIENT_LOCAL_DURABILITY_QOS;
+    subscriber_attrs.qos.m_reliability.kind = eprosima::fastrtps::RELIABLE_RELIABILITY_QOS;
+    info.listener_ = new SubListener(&info);
+    info.type_support_ = type_support;
+    info.type_support_impl_ = nullptr;
+    info.typesupport_identifier_ = identifier;
+    info.subscriber_ = Domain::createSubscriber(participant, subscriber_attrs, info.listener_);
+    ASSERT_NE(nullptr, info.subscriber_);
+
+    subscription.implementation_identifier = identifier;
+    subscription.data = &info;
+    subscription.topic_name = "test_take_sequence";
+    subscription.options.ignore_local_publications = false;
+    subscription.can_loan_messages = false;
+    for (size_t i = 0; i < 4; ++i) {
+      messages[i] = 0;
+      message_pointers[i] = &messages[i];
+    }
+    taken = 42;
+  }
+
+  void TearDown()
+  {
+    if (participant) {
+      // Removes the publisher, the subscriber and the registered type
+      Domain::removeParticipant(participant);
+    }
+    delete info.listener_;
+    delete type_support;
+  }
+
+  void publish(uint32_t value)
+  {
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.is_cdr_buffer = false;
+    data.data = &value;
+    data.impl = nullptr;
+    ASSERT_TRUE(publisher->write(&data));
+  }
+
+  bool wait_for_unread_count(uint64_t count)
+  {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (unread_count(info.subscriber_) < count) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+  }
+
+  rmw_ret_t take_sequence(size_t count)
+  {
+    return rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      identifier, &subscription, count, message_pointers, message_infos, &taken, nullptr);
+  }
+};
+
+TEST_F(TakeSequenceTestFixture, test_take_sequence_null_arguments)
+{
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      identifier, nullptr, 1, message_pointers, message_infos, &taken, nullptr));
+  rmw_reset_error();
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      identifier, &subscription, 1, nullptr, message_infos, &taken, nullptr));
+  rmw_reset_error();
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      identifier, &subscription, 1, message_pointers, message_infos, nullptr, nullptr));
+  rmw_reset_error();
+}
+
+TEST_F(TakeSequenceTestFixture, test_take_sequence_from_other_implementation)
+{
+  publish(1);
+  ASSERT_TRUE(wait_for_unread_count(1));
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      "other_implementation", &subscription, 4, message_pointers, message_infos, &taken,
+      nullptr));
+  rmw_reset_error();
+  EXPECT_EQ(0u, taken);
+  EXPECT_EQ(1u, unread_count(info.subscriber_));
+}
+
+TEST_F(TakeSequenceTestFixture, test_take_sequence_in_batches)
+{
+  publish(1);
+  publish(2);
+  publish(3);
+  ASSERT_TRUE(wait_for_unread_count(3));
+  EXPECT_TRUE(info.listener_->hasData());
+
+  // The listener sees what is left once the batch is taken
+  ASSERT_EQ(RMW_RET_OK, take_sequence(2));
+  ASSERT_EQ(2u, taken);
+  EXPECT_EQ(1u, messages[0]);
+  EXPECT_EQ(2u, messages[1]);
+  EXPECT_EQ(1u, unread_count(info.subscriber_));
+  EXPECT_TRUE(info.listener_->hasData());
+  for (size_t i = 0; i < taken; ++i) {
+    EXPECT_EQ(identifier, message_infos[i].publisher_gid.implementation_identifier);
+  }
+
+  ASSERT_EQ(RMW_RET_OK, take_sequence(4));
+  ASSERT_EQ(1u, taken);
+  EXPECT_EQ(3u, messages[0]);
+  EXPECT_EQ(0u, unread_count(info.subscriber_));
+  EXPECT_FALSE(info.listener_->hasData());
+
+  ASSERT_EQ(RMW_RET_OK, take_sequence(4));
+  EXPECT_EQ(0u, taken);
+  EXPECT_FALSE(info.listener_->hasData());
+}
+
+TEST_F(TakeSequenceTestFixture, test_take_sequence_without_message_infos)
+{
+  publish(7);
+  ASSERT_TRUE(wait_for_unread_count(1));
+  EXPECT_EQ(
+    RMW_RET_OK,
+    rmw_fastrtps_shared_cpp::__rmw_take_sequence(
+      identifier, &subscription, 4, message_pointers, nullptr, &taken, nullptr));
+  ASSERT_EQ(1u, taken);
+  EXPECT_EQ(7u, messages[0]);
+  EXPECT_FALSE(info.listener_->hasData());
+}
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <tuple>
@@ -126,6 +127,26 @@ TEST_F(TopicCacheTestFixture, test_topic_cache_get_topic_types)
   EXPECT_TRUE(std::find(topic_types.begin(), topic_types.end(), "type2") != topic_types.end());
 }
 
+TEST_F(TopicCacheTestFixture, test_topic_cache_get_topic_types_tracks_changes)
+{
+  // The map is kept up to date rather than rebuilt
+  const auto & topic_type_map = this->topic_cache.getTopicToTypes();
+  EXPECT_EQ(&topic_type_map, &this->topic_cache.getTopicToTypes());
+  EXPECT_TRUE(topic_type_map.find("topic3") == topic_type_map.end());
+
+  this->topic_cache.addTopic(
+    this->participant_instance_handler[0], this->guid[0], "topic3", "type3", this->qos[0]);
+  const auto & it = topic_type_map.find("topic3");
+  ASSERT_TRUE(it != topic_type_map.end());
+  EXPECT_EQ(it->second, std::vector<InternedString>({"type3"}));
+
+  this->topic_cache.removeTopic(
+    this->participant_instance_handler[0], this->guid[0], "topic2", "type2");
+  const auto & it2 = topic_type_map.find("topic2");
+  ASSERT_TRUE(it2 != topic_type_map.end());
+  EXPECT_EQ(it2->second, std::vector<InternedString>({"type1"}));
+}
+
 TEST_F(TopicCacheTestFixture, test_topic_cache_get_participant_map)
 {
   const auto & participant_topic_map = this->topic_cache.getParticipantToTopics();
@@ -263,3 +284,124 @@ TEST_F(TopicCacheTestFixture, test_topic_cache_remove_policy_element_does_not_ex
       "TestType");
   ASSERT_FALSE(did_remove);
 }
+
+TEST_F(TopicCacheTestFixture, test_topic_cache_remove_keeps_other_entities)
+{
+  GUID_t entity_guid[5];
+  for (uint32_t i = 0; i < 5; i++) {
+    entity_guid[i] = GUID_t(GuidPrefix_t(), 200 + i);
+    this->topic_cache.addTopic(
+      this->participant_guid[i % 2], entity_guid[i], "topic3", "type3", this->qos[0]);
+  }
+  // Remove from the middle, then from both ends
+  EXPECT_TRUE(this->topic_cache.removeTopic(
+      this->participant_guid[0], entity_guid[2], "topic3", "type3"));
+  EXPECT_TRUE(this->topic_cache.removeTopic(
+      this->participant_guid[0], entity_guid[0], "topic3", "type3"));
+  EXPECT_TRUE(this->topic_cache.removeTopic(
+      this->participant_guid[0], entity_guid[4], "topic3", "type3"));
+  // Already removed
+  EXPECT_FALSE(this->topic_cache.removeTopic(
+      this->participant_guid[0], entity_guid[2], "topic3", "type3"));
+
+  const auto & topic_data_map = this->topic_cache.getTopicNameToTopicData();
+  const auto & topic_data_it = topic_data_map.find("topic3");
+  ASSERT_TRUE(topic_data_it != topic_data_map.end());
+  std::vector<GUID_t> remaining;
+  for (const auto & topic_data : topic_data_it->second) {
+    EXPECT_EQ(this->participant_guid[1], topic_data.participant_guid);
+    remaining.push_back(topic_data.entity_guid);
+  }
+  std::sort(remaining.begin(), remaining.end());
+  EXPECT_EQ(std::vector<GUID_t>({entity_guid[1], entity_guid[3]}), remaining);
+  EXPECT_EQ(2u, this->topic_cache.getTopicToTypes().at("topic3").size());
+
+  const auto & participant_topic_map = this->topic_cache.getParticipantToTopics();
+  EXPECT_TRUE(
+    participant_topic_map.at(this->participant_guid[0]).find("topic3") ==
+    participant_topic_map.at(this->participant_guid[0]).end());
+  EXPECT_EQ(2u, participant_topic_map.at(this->participant_guid[1]).at("topic3").size());
+
+  // What is left can still be removed
+  EXPECT_TRUE(this->topic_cache.removeTopic(
+      this->participant_guid[1], entity_guid[3], "topic3", "type3"));
+  EXPECT_TRUE(this->topic_cache.removeTopic(
+      this->participant_guid[1], entity_guid[1], "topic3", "type3"));
+  EXPECT_TRUE(topic_data_map.find("topic3") == topic_data_map.end());
+}
+
+TEST_F(TopicCacheTestFixture, test_topic_cache_remove_swaps_with_last)
+{
+  // Removing an endpoint moves the last one of its topic into its place, instead of shifting
+  // the endpoints after it, so that removals do not depend on the number of endpoints
+  GUID_t participant_guid(GuidPrefix_t(), 10);
+  std::vector<GUID_t> entity_guids;
+  for (uint32_t i = 0; i < 6; ++i) {
+    entity_guids.push_back(GUID_t(GuidPrefix_t(), 300 + i));
+    ASSERT_TRUE(
+      this->topic_cache.addTopic(
+        participant_guid, entity_guids.back(), "topic4", "type4", this->qos[0]));
+  }
+  const auto & topic_data_map = this->topic_cache.getTopicNameToTopicData();
+
+  // Remove the first endpoint each time, and check the last one took its place
+  std::vector<GUID_t> expected = entity_guids;
+  while (!expected.empty()) {
+    ASSERT_TRUE(
+      this->topic_cache.removeTopic(participant_guid, expected.front(), "topic4", "type4"));
+    expected.front() = expected.back();
+    expected.pop_back();
+    if (expected.empty()) {
+      EXPECT_TRUE(topic_data_map.find("topic4") == topic_data_map.end());
+      break;
+    }
+    const auto & topic_data = topic_data_map.at("topic4");
+    ASSERT_EQ(expected.size(), topic_data.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i], topic_data[i].entity_guid);
+    }
+    EXPECT_EQ(expected.size(), this->topic_cache.getTopicToTypes().at("topic4").size());
+    EXPECT_EQ(
+      expected.size(),
+      this->topic_cache.getParticipantToTopics().at(participant_guid).at("topic4").size());
+  }
+  EXPECT_TRUE(
+    this->topic_cache.getParticipantToTopics().find(participant_guid) ==
+    this->topic_cache.getParticipantToTopics().end());
+}
+
+TEST_F(TopicCacheTestFixture, test_topic_cache_demangled_names)
+{
+  GUID_t entity_guid(GuidPrefix_t(), 200);
+  topic_cache.addTopic(
+    participant_guid[0], guid[0], "rt/chatter", "std_msgs::msg::dds_::String_", qos[0]);
+  topic_cache.addTopic(
+    participant_guid[0], entity_guid, "rq/add_two_intsRequest",
+    "example_interfaces::srv::dds_::AddTwoInts_Request_", qos[0]);
+
+  const DemangledTopic & topic = topic_cache.getDemangledTopic("rt/chatter");
+  EXPECT_TRUE(topic.is_ros_topic);
+  EXPECT_EQ("/chatter", topic.topic_name);
+  EXPECT_EQ("", topic.service_name);
+  const DemangledType & type = topic_cache.getDemangledType("std_msgs::msg::dds_::String_");
+  EXPECT_EQ("std_msgs/msg/String", type.type_name);
+  EXPECT_EQ("", type.service_type_name);
+
+  const DemangledTopic & request_topic = topic_cache.getDemangledTopic("rq/add_two_intsRequest");
+  EXPECT_FALSE(request_topic.is_ros_topic);
+  EXPECT_EQ("/add_two_ints", request_topic.service_name);
+  const DemangledType & request_type =
+    topic_cache.getDemangledType("example_interfaces::srv::dds_::AddTwoInts_Request_");
+  EXPECT_EQ("example_interfaces/srv/AddTwoInts", request_type.service_type_name);
+
+  // Still demangled for the publishers left once others are removed
+  topic_cache.addTopic(
+    participant_guid[1], guid[1], "rt/chatter", "std_msgs::msg::dds_::String_", qos[1]);
+  EXPECT_TRUE(
+    topic_cache.removeTopic(
+      participant_guid[0], guid[0], "rt/chatter", "std_msgs::msg::dds_::String_"));
+  EXPECT_EQ("/chatter", topic_cache.getDemangledTopic("rt/chatter").topic_name);
+  EXPECT_EQ(
+    "std_msgs/msg/String",
+    topic_cache.getDemangledType("std_msgs::msg::dds_::String_").type_name);
+}
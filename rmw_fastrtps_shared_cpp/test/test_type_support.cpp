@@ -0,0 +1,389 @@
+// Copyright 2016-2018 Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "fastrtps/Domain.h"
+#include "fastrtps/attributes/ParticipantAttributes.h"
+#include "fastrtps/attributes/PublisherAttributes.h"
+#include "fastrtps/attributes/SubscriberAttributes.h"
+#include "fastrtps/participant/Participant.h"
+#include "fastrtps/publisher/Publisher.h"
+#include "fastrtps/subscriber/Subscriber.h"
+
+#include "gtest/gtest.h"
+
+#include "rmw/error_handling.h"
+#include "rmw/serialized_message.h"
+
+#include "rmw_fastrtps_shared_cpp/custom_allocation_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_publisher_info.hpp"
+#include "rmw_fastrtps_shared_cpp/custom_subscriber_info.hpp"
+#include "rmw_fastrtps_shared_cpp/rmw_common.hpp"
+#include "rmw_fastrtps_shared_cpp/TypeSupport.hpp"
+
+using eprosima::fastcdr::FastBuffer;
+using eprosima::fastrtps::Domain;
+using eprosima::fastrtps::rtps::SerializedPayload_t;
+
+namespace
+{
+// Only the calling thread counts, not the threads of Fast-RTPS
+thread_local bool count_mallocs = false;
+std::atomic<size_t> malloc_count(0);
+}  // namespace
+
+#if defined(__GLIBC__)
+// Count the allocations made while count_mallocs is set, everything else goes to glibc
+extern "C" void * __libc_malloc(size_t size);
+
+extern "C" void * malloc(size_t size)
+{
+  if (count_mallocs) {
+    ++malloc_count;
+  }
+  return __libc_malloc(size);
+}
+#endif
+
+// Messages are a single uint32_t
+class TestTypeSupport : public rmw_fastrtps_shared_cpp::TypeSupport
+{
+public:
+  TestTypeSupport()
+  {
+    setName("test_type_support::msg::UInt32");
+    max_size_bound_ = true;
+    m_typeSize = 8;
+  }
+
+  size_t getEstimatedSerializedSize(const void *, const void *) override
+  {
+    return 8;
+  }
+
+  bool serializeROSmessage(
+    const void * ros_message, eprosima::fastcdr::Cdr & ser, const void *) override
+  {
+    ser.serialize_encapsulation();
+    ser << *static_cast<const uint32_t *>(ros_message);
+    return true;
+  }
+
+  bool deserializeROSmessage(
+    eprosima::fastcdr::Cdr & deser, void * ros_message, const void *) override
+  {
+    deser.read_encapsulation();
+    deser >> *static_cast<uint32_t *>(ros_message);
+    return true;
+  }
+};
+
+class TypeSupportTestFixture : public ::testing::Test
+{
+public:
+  TestTypeSupport type_support;
+  SerializedPayload_t payload{32};
+
+  void SetUp()
+  {
+    for (uint32_t i = 0; i < payload.max_size; ++i) {
+      payload.data[i] = static_cast<uint8_t>(i);
+    }
+    payload.length = 12;
+  }
+
+  bool deserialize(FastBuffer & buffer, size_t & mallocs)
+  {
+    rmw_fastrtps_shared_cpp::SerializedData data;
+    data.is_cdr_buffer = true;
+    data.data = &buffer;
+    data.impl = nullptr;
+    data.length = 0;
+
+    malloc_count = 0;
+    count_mallocs = true;
+    bool ret = type_support.deserialize(&payload, &data);
+    count_mallocs = false;
+    mallocs = malloc_count;
+    if (ret) {
+      EXPECT_EQ(payload.length, data.length);
+      EXPECT_EQ(0, memcmp(buffer.getBuffer(), payload.data, payload.length));
+    }
+    return ret;
+  }
+};
+
+TEST_F(TypeSupportTestFixture, test_deserialize_cdr_buffer_into_caller_storage)
+{
+  char storage[64];
+  FastBuffer buffer(storage, sizeof(storage));
+  size_t mallocs = 0;
+  ASSERT_TRUE(deserialize(buffer, mallocs));
+  EXPECT_EQ(0u, mallocs);
+  EXPECT_EQ(storage, buffer.getBuffer());
+  EXPECT_EQ(sizeof(storage), buffer.getBufferSize());
+
+  // Storage is reused take after take
+  payload.length = 20;
+  ASSERT_TRUE(deserialize(buffer, mallocs));
+  EXPECT_EQ(0u, mallocs);
+  EXPECT_EQ(storage, buffer.getBuffer());
+}
+
+TEST_F(TypeSupportTestFixture, test_deserialize_cdr_buffer_too_big_for_caller_storage)
+{
+  char storage[8];
+  FastBuffer buffer(storage, sizeof(storage));
+  size_t mallocs = 0;
+  EXPECT_FALSE(deserialize(buffer, mallocs));
+  EXPECT_EQ(0u, mallocs);
+}
+
+TEST_F(TypeSupportTestFixture, test_deserialize_cdr_buffer_owning_storage)
+{
+  FastBuffer buffer;
+  size_t mallocs = 0;
+  ASSERT_TRUE(deserialize(buffer, mallocs));
+
+  // Once big enough, the storage of the buffer is reused
+  payload.length = 8;
+  ASSERT_TRUE(deserialize(buffer, mallocs));
+  EXPECT_EQ(0u, mallocs);
+
+  // and grown if needed
+  payload.length = 32;
+  ASSERT_TRUE(deserialize(buffer, mallocs));
+  EXPECT_LE(payload.length, buffer.getBufferSize());
+}
+
+TEST_F(TypeSupportTestFixture, test_deserialize_cdr_buffer_discarded)
+{
+  rmw_fastrtps_shared_cpp::SerializedData data;
+  data.is_cdr_buffer = true;
+  data.data = nullptr;
+  data.impl = nullptr;
+  data.length = 1;
+
+  malloc_count = 0;
+  count_mallocs = true;
+  bool ret = type_support.deserialize(&payload, &data);
+  count_mallocs = false;
+  EXPECT_TRUE(ret);
+  EXPECT_EQ(0u, malloc_count);
+  EXPECT_EQ(0u, data.length);
+}
+
+// Publishes and takes through a participant of this process, with allocations
+class AllocationTestFixture : public ::testing::Test
+{
+public:
+  const char * identifier = "test_type_support";
+  eprosima::fastrtps::Participant * participant = nullptr;
+  TestTypeSupport * type_support = nullptr;
+  CustomPublisherInfo publisher_info;
+  CustomSubscriberInfo subscriber_info;
+  rmw_publisher_t publisher;
+  rmw_subscription_t subscription;
+  rmw_publisher_allocation_t publisher_allocation;
+  rmw_subscription_allocation_t subscription_allocation;
+
+  void SetUp()
+  {
+    subscriber_info.listener_ = nullptr;
+    publisher_allocation.data = nullptr;
+    subscription_allocation.data = nullptr;
+
+    eprosima::fastrtps::ParticipantAttributes participant_attrs;
+    Domain::getDefaultParticipantAttributes(participant_attrs);
+    participant = Domain::createParticipant(participant_attrs, nullptr);
+    ASSERT_NE(nullptr, participant);
+    type_support = new TestTypeSupport();
+    ASSERT_TRUE(Domain::registerType(participant, type_support));
+
+    // Reliable and transient local, so no sample is lost while the endpoints match
+    eprosima::fastrtps::PublisherAttributes publisher_attrs;
+    Domain::getDefaultPublisherAttributes(publisher_attrs);
+    publisher_attrs.topic.topicKind = eprosima::fastrtps::rtps::NO_KEY;
+    publisher_attrs.topic.topicDataType = type_support->getName();
+    publisher_attrs.topic.topicName = "test_type_support";
+    publisher_attrs.topic.historyQos.kind = eprosima::fastrtps::KEEP_ALL_HISTORY_QOS;
+    publisher_attrs.qos.m_durability.kind = eprosima::fastrtps::TRANSIENT_LOCAL_DURABILITY_QOS;
+    publisher_attrs.qos.m_reliability.kind = eprosima::fastrtps::RELIABLE_RELIABILITY_QOS;
+    publisher_info.listener_ = nullptr;
+    publisher_info.type_support_ = type_support;
+    publisher_info.type_support_impl_ = nullptr;
+    publisher_info.typesupport_identifier_ = identifier;
+    publisher_info.publisher_ = Domain::createPublisher(participant, publisher_attrs, nullptr);
+    ASSERT_NE(nullptr, publisher_info.publisher_);
+
+    eprosima::fastrtps::SubscriberAttributes subscriber_attrs;
+    Domain::getDefaultSubscriberAttributes(subscriber_attrs);
+    subscriber_attrs.topic = publisher_attrs.topic;
+    subscriber_attrs.qos.m_durability.kind = eprosima::fastrtps::TRANSIENT_LOCAL_DURABILITY_QOS;
+    subscriber_attrs.qos.m_reliability.kind = eprosima::fastrtps::RELIABLE_RELIABILITY_QOS;
+    subscriber_info.listener_ = new SubListener(&subscriber_info);
+    subscriber_info.type_support_ = type_support;
+    subscriber_info.type_support_impl_ = nullptr;
+    subscriber_info.typesupport_identifier_ = identifier;
+    subscriber_info.subscriber_ =
+      Domain::createSubscriber(participant, subscriber_attrs, subscriber_info.listener_);
+    ASSERT_NE(nullptr, subscriber_info.subscriber_);
+
+    publisher.implementation_identifier = identifier;
+    publisher.data = &publisher_info;
+    publisher.topic_name = "test_type_support";
+    publisher.can_loan_messages = false;
+    subscription.implementation_identifier = identifier;
+    subscription.data = &subscriber_info;
+    subscription.topic_name = "test_type_support";
+    subscription.options.ignore_local_publications = false;
+    subscription.can_loan_messages = false;
+
+    ASSERT_EQ(
+      RMW_RET_OK, rmw_fastrtps_shared_cpp::__rmw_init_publisher_allocation(
+        identifier, type_support->getMaxSerializedSize(), &publisher_allocation));
+    ASSERT_EQ(
+      RMW_RET_OK, rmw_fastrtps_shared_cpp::__rmw_init_subscription_allocation(
+        identifier, type_support->getMaxSerializedSize(), &subscription_allocation));
+  }
+
+  void TearDown()
+  {
+    if (publisher_allocation.data) {
+      EXPECT_EQ(
+        RMW_RET_OK, rmw_fastrtps_shared_cpp::__rmw_fini_publisher_allocation(
+          identifier, &publisher_allocation));
+    }
+    if (subscription_allocation.data) {
+      EXPECT_EQ(
+        RMW_RET_OK, rmw_fastrtps_shared_cpp::__rmw_fini_subscription_allocation(
+          identifier, &subscription_allocation));
+    }
+    if (participant) {
+      // Removes the publisher, the subscriber and the registered type
+      Domain::removeParticipant(participant);
+    }
+    delete subscriber_info.listener_;
+    delete type_support;
+  }
+
+  void publish(uint32_t value)
+  {
+    ASSERT_EQ(
+      RMW_RET_OK,
+      rmw_fastrtps_shared_cpp::__rmw_publish(
+        identifier, &publisher, &value, &publisher_allocation));
+  }
+
+  bool wait_for_data()
+  {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!subscriber_info.listener_->hasData()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+  }
+};
+
+TEST_F(AllocationTestFixture, test_publish_and_take_with_allocations)
+{
+  publish(42);
+  ASSERT_TRUE(wait_for_data());
+
+  uint32_t ros_message = 0;
+  bool taken = false;
+  rmw_message_info_t message_info;
+  ASSERT_EQ(
+    RMW_RET_OK,
+    rmw_fastrtps_shared_cpp::__rmw_take_with_info(
+      identifier, &subscription, &ros_message, &taken, &message_info, &subscription_allocation));
+  ASSERT_TRUE(taken);
+  EXPECT_EQ(42u, ros_message);
+
+  // The sample info is the one of the allocation
+  CustomAllocationInfo * allocation_info =
+    rmw_fastrtps_shared_cpp::get_allocation_info(identifier, &subscription_allocation);
+  ASSERT_NE(nullptr, allocation_info);
+  EXPECT_EQ(
+    publisher_info.publisher_->getGuid(),
+    allocation_info->sample_info_.sample_identity.writer_guid());
+  EXPECT_EQ(identifier, message_info.publisher_gid.implementation_identifier);
+}
+
+TEST_F(AllocationTestFixture, test_take_serialized_does_not_allocate)
+{
+  CustomAllocationInfo * allocation_info =
+    rmw_fastrtps_shared_cpp::get_allocation_info(identifier, &subscription_allocation);
+  ASSERT_NE(nullptr, allocation_info);
+  char * storage = allocation_info->buffer_.getBuffer();
+  ASSERT_NE(nullptr, storage);
+
+  rmw_serialized_message_t serialized_message = rmw_get_zero_initialized_serialized_message();
+  rcutils_allocator_t allocator = rcutils_get_default_allocator();
+  ASSERT_EQ(
+    RMW_RET_OK,
+    rmw_serialized_message_init(
+      &serialized_message, type_support->getMaxSerializedSize(), &allocator));
+
+  for (uint32_t value = 1; value <= 2; ++value) {
+    publish(value);
+    ASSERT_TRUE(wait_for_data());
+
+    bool taken = false;
+    rmw_message_info_t message_info;
+    malloc_count = 0;
+    count_mallocs = true;
+    rmw_ret_t ret = rmw_fastrtps_shared_cpp::__rmw_take_serialized_message_with_info(
+      identifier, &subscription, &serialized_message, &taken, &message_info,
+      &subscription_allocation);
+    count_mallocs = false;
+    ASSERT_EQ(RMW_RET_OK, ret);
+    ASSERT_TRUE(taken);
+    EXPECT_EQ(0u, malloc_count);
+    // Taken into the buffer of the allocation, then copied into the serialized message
+    EXPECT_EQ(storage, allocation_info->buffer_.getBuffer());
+    EXPECT_EQ(8u, serialized_message.buffer_length);
+    EXPECT_EQ(0, memcmp(storage, serialized_message.buffer, serialized_message.buffer_length));
+  }
+
+  EXPECT_EQ(RMW_RET_OK, rmw_serialized_message_fini(&serialized_message));
+}
+
+TEST_F(AllocationTestFixture, test_allocation_from_other_implementation)
+{
+  EXPECT_EQ(
+    nullptr, rmw_fastrtps_shared_cpp::get_allocation_info("other", &publisher_allocation));
+  rmw_reset_error();
+  EXPECT_EQ(
+    nullptr, rmw_fastrtps_shared_cpp::get_allocation_info("other", &subscription_allocation));
+  rmw_reset_error();
+
+  rmw_publisher_allocation_t other_allocation;
+  other_allocation.implementation_identifier = "other";
+  other_allocation.data = publisher_allocation.data;
+  uint32_t ros_message = 42;
+  EXPECT_EQ(
+    RMW_RET_ERROR,
+    rmw_fastrtps_shared_cpp::__rmw_publish(
+      identifier, &publisher, &ros_message, &other_allocation));
+  rmw_reset_error();
+}